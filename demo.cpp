@@ -1,4 +1,5 @@
 #include "test/TestLexer.h"
+#include "test/Benchmarks.h"
 
 #define RUN_TESTS
 
@@ -55,7 +56,7 @@ int main(int argc, char ** args) {
                 .Where(HEYA(p, p["WHO"].Equals("Janet")))
                 .back()
                 ["WEEK"]
-                .Where(HEYA(p, p["NUMBER"].Equals("5")))
+                .Where(HEYA(p, p["NUMBER"].Equals(5)))
                 .back()
                 ["EXPENSE"]
                 .Where(HEYA(p, p["WHAT"].Equals("Car")))
@@ -71,5 +72,12 @@ int main(int argc, char ** args) {
     }
     #endif
 
+    #ifdef RUN_BENCHMARKS
+    {
+        Benchmarks::Init();
+        Benchmarks::Run(std::cout);
+    }
+    #endif
+
     return 0;
 }
@@ -0,0 +1,43 @@
+#include "BufferEnumerator.h"
+
+BufferEnumerator::BufferEnumerator(
+    const char * sequence,
+    size_t size
+):  _sequence(sequence),
+    _index(0),
+    _size((int)size)
+    {}
+
+void BufferEnumerator::Reset(
+    const char * sequence,
+    size_t size
+) {
+    _sequence = sequence;
+    _index = 0;
+    _size = (int)size;
+}
+
+// Same contract as StreamEnumerator: Current is the last character
+// read, and HasNext turns false only once a read has gone past the
+// end
+char BufferEnumerator::Current() const {
+    return _index > 0 && _index <= _size
+        ? _sequence[_index - 1]
+        : '\0';
+}
+
+int BufferEnumerator::Index() const {
+    return _index;
+}
+
+bool BufferEnumerator::HasNext() const {
+    return _index <= _size;
+}
+
+bool BufferEnumerator::Next(char & element) {
+    if (_index < _size)
+        element = _sequence[_index];
+
+    _index = _index + 1;
+    return HasNext();
+}
@@ -0,0 +1,27 @@
+#pragma once
+#ifndef _BUFFERENUMERATOR_H
+#define _BUFFERENUMERATOR_H
+
+#include "IEnumerator.h"
+#include <cstddef>
+
+// Enumerates a character buffer without copying it. The buffer
+// must outlive the enumerator.
+class BufferEnumerator: public IEnumerator {
+    private:
+        const char * _sequence;
+        int _index;
+        int _size;
+    public:
+        BufferEnumerator(const char * sequence, size_t size);
+
+        // Starts over on another buffer
+        void Reset(const char * sequence, size_t size);
+
+        virtual char Current() const;
+        virtual int Index() const;
+        virtual bool HasNext() const override;
+        virtual bool Next(char & element) override;
+};
+
+#endif
@@ -1,4 +1,7 @@
 #include "Homonumeric.h"
+#include <climits>
+#include <cstdlib>
+#include <string>
 
 Homonumeric Homonumeric::Integer(int value) {
     Homonumeric temp;
@@ -26,4 +29,74 @@ Homonumeric Homonumeric::Character(char value) {
     temp.Mode = Mode::CHARACTER;
     temp.Payload.Character = value;
     return temp;
-}
\ No newline at end of file
+}
+
+Homonumeric Homonumeric::Raw(const char * text, int length) {
+    Homonumeric temp;
+    temp.Mode = Mode::RAW;
+    temp.Payload.Raw.Text = text;
+    temp.Payload.Raw.Length = length;
+    temp.Payload.Raw.Kind = Classify(text, length);
+    return temp;
+}
+
+Homonumeric::Class Homonumeric::Classify(const char * text, int length) {
+    Class temp = Class::INTEGRAL;
+
+    for (int i = 0; i < length; ++i) {
+        switch (text[i]) {
+            case 'e':
+            case 'E':
+                return Class::EXPONENT;
+            case '.':
+                temp = Class::DECIMAL;
+                break;
+            default:
+                break;
+        }
+    }
+
+    return temp;
+}
+
+bool Homonumeric::AsInteger(int & value) const {
+    switch (Mode) {
+        case Mode::INTEGER:
+            value = Payload.Integer;
+            return true;
+        case Mode::RAW:
+            if (Payload.Raw.Kind != Class::INTEGRAL)
+                return false;
+
+            {
+                // The text is not null-terminated
+                std::string text(Payload.Raw.Text, Payload.Raw.Length);
+                long long temp = std::strtoll(text.c_str(), nullptr, 10);
+
+                if (temp < INT_MIN || temp > INT_MAX)
+                    return false;
+
+                value = (int)temp;
+                return true;
+            }
+        default:
+            return false;
+    }
+}
+
+bool Homonumeric::AsFloat(float & value) const {
+    switch (Mode) {
+        case Mode::FLOAT:
+            value = Payload.Float;
+            return true;
+        case Mode::RAW:
+            value = std::strtof(
+                std::string(Payload.Raw.Text, Payload.Raw.Length).c_str(),
+                nullptr
+            );
+
+            return true;
+        default:
+            return false;
+    }
+}
@@ -8,7 +8,23 @@ class Homonumeric {
             INTEGER,
             FLOAT,
             BOOLEAN,
-            CHARACTER
+            CHARACTER,
+            RAW
+        };
+
+        // Form of the source text of a RAW number
+        enum Class {
+            INTEGRAL,
+            DECIMAL,
+            EXPONENT
+        };
+
+        // Source text of a number, not yet converted. The text is
+        // not owned; whoever keeps the Homonumeric keeps the text.
+        struct Span {
+            const char * Text;
+            int Length;
+            Class Kind;
         };
 
         union Definition {
@@ -16,6 +32,7 @@ class Homonumeric {
             float Float;
             bool Boolean;
             char Character;
+            Span Raw;
         };
 
         Mode Mode;
@@ -25,6 +42,13 @@ class Homonumeric {
         static Homonumeric Float(float value = 0.0);
         static Homonumeric Boolean(bool value = false);
         static Homonumeric Character(char);
+        static Homonumeric Raw(const char * text, int length);
+
+        static Class Classify(const char * text, int length);
+
+        // Convert RAW text on every call
+        bool AsInteger(int &) const;
+        bool AsFloat(float &) const;
 };
 
 #endif
\ No newline at end of file
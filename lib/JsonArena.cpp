@@ -0,0 +1,14 @@
+#include "JsonArena.h"
+
+Json::Arena::Arena(size_t blockSize):
+    _resource(blockSize) {}
+
+std::pmr::memory_resource *
+Json::Arena::Resource() {
+    return &_resource;
+}
+
+void
+Json::Arena::Release() {
+    _resource.release();
+}
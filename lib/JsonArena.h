@@ -0,0 +1,68 @@
+#pragma once
+#ifndef _JSONARENA_H
+#define _JSONARENA_H
+
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace Json {
+    // Strings and key arrays held by tree nodes. They allocate from
+    // the memory resource of the factory that built the node.
+    typedef std::pmr::string
+    tree_string_t;
+
+    typedef std::pmr::vector<tree_string_t>
+    tree_keys_t;
+
+    // Monotonic block allocator. Memory handed out is returned all
+    // at once, when the arena is released or destroyed; nothing in
+    // it is destroyed one by one.
+    class Arena {
+        private:
+            std::pmr::monotonic_buffer_resource _resource;
+        public:
+            static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+            virtual ~Arena() = default;
+            Arena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+            Arena(const Arena &) = delete;
+            Arena & operator=(const Arena &) = delete;
+
+            std::pmr::memory_resource * Resource();
+
+            template <typename T, typename... Args>
+            T * New(Args &&... args);
+
+            // Invalidates everything allocated from the arena
+            void Release();
+    };
+
+    // Deletes a tree node, unless the node was placed in an arena,
+    // which releases it as part of a block
+    template <typename Tree_Type>
+    struct TreeDeleter {
+        TreeDeleter() = default;
+
+        template <typename Other_Type>
+        TreeDeleter(const std::default_delete<Other_Type> &) {}
+
+        template <typename Other_Type>
+        TreeDeleter(const TreeDeleter<Other_Type> &) {}
+
+        void operator()(Tree_Type * tree) const {
+            if (!tree->InArena())
+                delete tree;
+        }
+    };
+};
+
+template <typename T, typename... Args>
+T *
+Json::Arena::New(Args &&... args) {
+    void * memory = _resource.allocate(sizeof(T), alignof(T));
+    return new (memory) T(std::forward<Args>(args)...);
+}
+
+#endif
@@ -0,0 +1,120 @@
+#include "JsonColumns.h"
+#include <bitset>
+#include <limits>
+
+Json::Column::Column(
+    const std::string & name,
+    size_t size
+):  _name(name),
+    _values(size, 0.0),
+    _valid((size + BLOCK - 1) / BLOCK, 0) {}
+
+const std::string &
+Json::Column::Name() const {
+    return _name;
+}
+
+size_t
+Json::Column::Size() const {
+    return _values.size();
+}
+
+const std::vector<double> &
+Json::Column::Values() const {
+    return _values;
+}
+
+const std::vector<uint64_t> &
+Json::Column::Validity() const {
+    return _valid;
+}
+
+bool
+Json::Column::Valid(size_t index) const {
+    return (_valid[index / BLOCK] >> (index % BLOCK)) & 1;
+}
+
+void
+Json::Column::Set(size_t index, double value) {
+    _values[index] = value;
+    _valid[index / BLOCK] |= (uint64_t)1 << (index % BLOCK);
+}
+
+size_t
+Json::Column::Count() const {
+    size_t count = 0;
+
+    for (uint64_t word : _valid)
+        count += std::bitset<BLOCK>(word).count();
+
+    return count;
+}
+
+double
+Json::Column::Sum() const {
+    // Nulls are 0, so every value can be added. Four sums let the
+    // additions overlap.
+    const double * values = _values.data();
+    size_t size = _values.size();
+    double sums[4] = { 0, 0, 0, 0 };
+    size_t i = 0;
+
+    for (; i + 4 <= size; i += 4)
+        for (int lane = 0; lane < 4; ++lane)
+            sums[lane] += values[i + lane];
+
+    for (; i < size; ++i)
+        sums[0] += values[i];
+
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+template <typename S>
+double
+Json::Column::Fold(double start, S && select) const {
+    const double * values = _values.data();
+    double lanes[4] = { start, start, start, start };
+
+    for (size_t block = 0; block < _valid.size(); ++block) {
+        uint64_t word = _valid[block];
+        size_t first = block * BLOCK;
+
+        if (word == ~(uint64_t)0)
+            // Every value valid
+            for (size_t i = first; i < first + BLOCK; i += 4)
+                for (int lane = 0; lane < 4; ++lane)
+                    lanes[lane] = select(lanes[lane], values[i + lane]);
+        else
+            for (size_t i = 0; word; ++i, word >>= 1)
+                if (word & 1)
+                    lanes[0] = select(lanes[0], values[first + i]);
+    }
+
+    return select(select(lanes[0], lanes[1]), select(lanes[2], lanes[3]));
+}
+
+double
+Json::Column::Min() const {
+    if (!Count())
+        return 0;
+
+    return Fold(std::numeric_limits<double>::infinity(), [](double a, double b) {
+        return b < a ? b : a;
+    });
+}
+
+double
+Json::Column::Max() const {
+    if (!Count())
+        return 0;
+
+    return Fold(-std::numeric_limits<double>::infinity(), [](double a, double b) {
+        return b > a ? b : a;
+    });
+}
+
+double
+Json::Column::Mean() const {
+    size_t count = Count();
+    return count ? Sum() / count : 0;
+}
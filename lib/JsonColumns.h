@@ -0,0 +1,57 @@
+#pragma once
+#ifndef _JSONCOLUMNS_H
+#define _JSONCOLUMNS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Json {
+    // Values of one field across a list of records, as contiguous
+    // doubles, with one validity bit per record. A record that lacks
+    // the field, or whose value is not a number or a boolean, is
+    // null: its bit is clear and its value is 0.
+    //
+    // The aggregates run over whole blocks of 64 records with no
+    // branch per value, in a form the compiler vectorizes. Each
+    // skips the nulls; Min, Max and Mean are 0 for a column with no
+    // valid value.
+    class Column {
+        public:
+            static const size_t BLOCK = 64;
+        private:
+            std::string _name;
+
+            std::vector<double>
+            _values;
+
+            // Bit i of word i / BLOCK is set for a valid value i
+            std::vector<uint64_t>
+            _valid;
+
+            template <typename Select_Type>
+            double Fold(double start, Select_Type && select) const;
+        public:
+            virtual ~Column() = default;
+
+            // Every value null
+            Column(const std::string & name, size_t size);
+
+            const std::string & Name() const;
+            size_t Size() const;
+
+            const std::vector<double> & Values() const;
+            const std::vector<uint64_t> & Validity() const;
+
+            bool Valid(size_t) const;
+            void Set(size_t, double);
+
+            size_t Count() const;
+            double Sum() const;
+            double Min() const;
+            double Max() const;
+            double Mean() const;
+    };
+};
+
+#endif
@@ -0,0 +1,28 @@
+#include "JsonFrozen.h"
+
+Json::FrozenMachine::FrozenMachine(
+    Machine && machine
+):  _machine(std::make_shared<const Machine>(std::move(machine))) {
+    _machine->ConvertNumbers();
+    _machine->ComputeHashes();
+}
+
+const Json::Machine &
+Json::FrozenMachine::operator*() const {
+    return *_machine;
+}
+
+const Json::Machine *
+Json::FrozenMachine::operator->() const {
+    return _machine.get();
+}
+
+Json::FrozenMachine::result_set_t
+Json::FrozenMachine::GetResultSet() const {
+    return _machine->GetResultSet();
+}
+
+Json::FrozenMachine::result_set_t
+Json::FrozenMachine::GetResultSet(key_t start) const {
+    return _machine->GetResultSet(start);
+}
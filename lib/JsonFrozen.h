@@ -0,0 +1,40 @@
+#pragma once
+#ifndef _JSONFROZEN_H
+#define _JSONFROZEN_H
+
+#include "JsonMachine.h"
+
+namespace Json {
+    // Machine that can no longer be changed, for any number of
+    // threads to read at once without locking.
+    //
+    // Made by moving a Machine in, so no one else holds a reference
+    // to it that could change it. Only const access is given out; a
+    // const Machine writes on read to convert raw numbers and to
+    // cache structural hashes, both done here up front, and to build
+    // field indexes, which it does under a lock. Every const member
+    // function of the Machine, its lists and objects, and
+    // ResultSet<const Machine *>, WhereEquals and WhereBetween
+    // included, is then safe to call from any thread.
+    //
+    // A KeyCache writes to itself on lookup, so each thread needs its
+    // own. Copies of a FrozenMachine share the same Machine.
+    class FrozenMachine {
+        private:
+            std::shared_ptr<const Machine> _machine;
+        public:
+            typedef Machine::ResultSet<const Machine *>
+            result_set_t;
+
+            virtual ~FrozenMachine() = default;
+            FrozenMachine(Machine &&);
+
+            const Machine & operator*() const;
+            const Machine * operator->() const;
+
+            result_set_t GetResultSet() const;
+            result_set_t GetResultSet(key_t start) const;
+    };
+};
+
+#endif
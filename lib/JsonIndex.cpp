@@ -0,0 +1,80 @@
+#include "JsonIndex.h"
+#include <algorithm>
+
+bool
+Json::FieldIndex::Hashed() const {
+    return _has_hashes;
+}
+
+bool
+Json::FieldIndex::Ordered() const {
+    return _has_order;
+}
+
+void
+Json::FieldIndex::AddHash(uint64_t hash, size_t position) {
+    _hashed[hash].push_back(position);
+}
+
+void
+Json::FieldIndex::FinishHashes() {
+    _has_hashes = true;
+}
+
+void
+Json::FieldIndex::AddNumber(double value, size_t position) {
+    _ordered.push_back(Entry { value, position });
+}
+
+void
+Json::FieldIndex::FinishOrder() {
+    // Equal numbers stay in list order
+    std::sort(_ordered.begin(), _ordered.end(), [](const Entry & a, const Entry & b) {
+        return a.Value < b.Value
+            || (a.Value == b.Value && a.Position < b.Position);
+    });
+
+    _has_order = true;
+}
+
+const std::vector<size_t> &
+Json::FieldIndex::Find(uint64_t hash) const {
+    static const std::vector<size_t> none;
+    auto found = _hashed.find(hash);
+    return found == _hashed.end() ? none : found->second;
+}
+
+std::vector<size_t>
+Json::FieldIndex::Between(double low, double high) const {
+    auto first = std::lower_bound(_ordered.begin(), _ordered.end(), low, [](const Entry & entry, double value) {
+        return entry.Value < value;
+    });
+
+    auto last = std::upper_bound(first, _ordered.end(), high, [](double value, const Entry & entry) {
+        return value < entry.Value;
+    });
+
+    std::vector<size_t> positions;
+    positions.reserve(last > first ? last - first : 0);
+
+    for (; first < last; ++first)
+        positions.push_back(first->Position);
+
+    return positions;
+}
+
+Json::FieldIndexCache::FieldIndexCache(const FieldIndexCache &) {}
+
+Json::FieldIndexCache &
+Json::FieldIndexCache::operator=(const FieldIndexCache & other) {
+    if (this != &other)
+        Clear();
+
+    return *this;
+}
+
+void
+Json::FieldIndexCache::Clear() {
+    if (!_indexes.empty())
+        _indexes.clear();
+}
@@ -0,0 +1,109 @@
+#pragma once
+#ifndef _JSONINDEX_H
+#define _JSONINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Json {
+    // Index of one field over the records of a list, by position in
+    // the list. The hash half maps the structural hash of a value of
+    // the field to the records that hold it; the ordered half holds
+    // the records whose value is a number, sorted by the number.
+    //
+    // Machine::HashIndex and Machine::OrderedIndex build each half
+    // the first time it is asked for; other Machines build an index
+    // on every call. A hash can collide, so Find gives candidates for
+    // the caller to check.
+    class FieldIndex {
+        public:
+            struct Entry {
+                double Value;
+                size_t Position;
+            };
+        private:
+            std::unordered_map<uint64_t, std::vector<size_t>>
+            _hashed;
+
+            std::vector<Entry>
+            _ordered;
+
+            bool
+            _has_hashes = false;
+
+            bool
+            _has_order = false;
+        public:
+            virtual ~FieldIndex() = default;
+
+            bool Hashed() const;
+            bool Ordered() const;
+
+            // Positions are added in list order
+            void AddHash(uint64_t hash, size_t position);
+            void FinishHashes();
+            void AddNumber(double value, size_t position);
+            void FinishOrder();
+
+            // In list order; empty for a hash no record holds
+            const std::vector<size_t> & Find(uint64_t hash) const;
+
+            // Of the numbers from low to high, inclusive, in order of
+            // the number, then of position
+            std::vector<size_t> Between(double low, double high) const;
+    };
+
+    // Indexes of a Machine, by list key, then by field. Get builds
+    // each half of an index once, under a lock, so any number of
+    // threads can ask for indexes at once. Clear is not safe while
+    // another thread uses the cache. A copy starts empty.
+    class FieldIndexCache {
+        private:
+            std::unordered_map<int, std::unordered_map<std::string, FieldIndex>>
+            _indexes;
+
+            std::mutex
+            _lock;
+        public:
+            FieldIndexCache() = default;
+            FieldIndexCache(const FieldIndexCache &);
+            FieldIndexCache & operator=(const FieldIndexCache &);
+            virtual ~FieldIndexCache() = default;
+
+            // The index of the field over the list. If the half asked
+            // for is not built yet, Fill_Type is called on the index
+            // to build it.
+            template <typename Fill_Type>
+            const FieldIndex & Get(
+                int list,
+                const std::string & field,
+                bool ordered,
+                Fill_Type && fill
+            );
+
+            void Clear();
+    };
+};
+
+template <typename F>
+const Json::FieldIndex &
+Json::FieldIndexCache::Get(
+    int list,
+    const std::string & field,
+    bool ordered,
+    F && fill
+) {
+    std::lock_guard<std::mutex> guard(_lock);
+    FieldIndex & index = _indexes[list][field];
+
+    if (!(ordered ? index.Ordered() : index.Hashed()))
+        fill(index);
+
+    return index;
+}
+
+#endif
@@ -1,4 +1,7 @@
 #include "JsonMachine.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
 
 std::string
 Json::ToString(Json::Type typeCode) {
@@ -22,7 +25,55 @@ Json::ToString(Json::Type typeCode) {
     return "";
 }
 
+uint64_t
+Json::HashMix(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+uint64_t
+Json::HashNumber(double value) {
+    // -0 and 0 are equal
+    if (value == 0)
+        value = 0;
+
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof bits);
+    return HashMix(0x165667B19E3779F9ULL ^ bits);
+}
+
+uint64_t
+Json::HashString(std::string_view value) {
+    return HashMix(0x9E3779B97F4A7C15ULL ^ std::hash<std::string_view>()(value));
+}
+
+uint64_t
+Json::HashBoolean(bool value) {
+    return HashMix(0xD6E8FEB86659FD93ULL + value);
+}
+
+int
+Json::TypeRank(Json::Type typeCode) {
+    switch (typeCode) {
+        case Json::Type::BOOLEAN:
+            return 1;
+        case Json::Type::INTEGER:
+        case Json::Type::FLOAT:
+            return 2;
+        case Json::Type::STRING:
+            return 3;
+        case Json::Type::LIST:
+            return 4;
+        case Json::Type::OBJECT:
+            return 5;
+        default:
+            return 0;
+    }
+}
+
 Json::Machine::Machine():
+    _root_shape(std::make_shared<object_t::shape_t>()),
     _start(-1) {}
 
 void
@@ -30,9 +81,234 @@ Json::Machine::SetStartingObject(key_t start) {
     _start = start;
 }
 
+void
+Json::Machine::Reserve(const PoolSizes & sizes) {
+    if (_string_slots.empty() && !_interning)
+        _strings.reserve(_strings.size() + sizes.Strings);
+    else
+        _string_slots.reserve(_string_slots.size() + sizes.Strings);
+
+    _integers.reserve(_integers.size() + sizes.Integers);
+    _floats.reserve(_floats.size() + sizes.Floats);
+    _booleans.reserve(_booleans.size() + sizes.Booleans);
+    _lists.reserve(_lists.size() + sizes.Lists);
+    _objects.reserve(_objects.size() + sizes.Objects);
+}
+
+template <typename R>
+Json::Pointer
+Json::Machine::CopyFrom(const Json::Machine & other, Pointer root, R && remap) {
+    struct Frame {
+        Pointer Old;
+        Pointer New;
+        size_t Next;
+    };
+
+    std::vector<Frame> frames;
+
+    auto copy = [&](Pointer value) -> Pointer {
+        if (value.type == Type::NIL)
+            return value;
+
+        key_t & key = remap(value);
+
+        if (key >= 0)
+            return Pointer { value.type, key };
+
+        Pointer result;
+
+        switch (value.type) {
+            case Type::STRING:
+                result = AddString(other.String(value.key));
+                break;
+            case Type::INTEGER:
+            case Type::FLOAT:
+                if (auto text = other.SourceText(value); !text.empty())
+                    result = NewNumber(std::string(text));
+                else if (value.type == Type::INTEGER)
+                    result = NewInteger(other.Integer(value.key));
+                else
+                    result = NewFloat(other.Float(value.key));
+
+                break;
+            case Type::BOOLEAN:
+                result = NewBoolean(other.Boolean(value.key));
+                break;
+            case Type::OBJECT:
+                result = NewObject();
+                Object(result.key).reserve(other.Object(value.key).size());
+                frames.push_back(Frame { value, result, 0 });
+                break;
+            case Type::LIST:
+                result = NewList();
+                List(result.key).reserve(other.List(value.key).size());
+                frames.push_back(Frame { value, result, 0 });
+                break;
+            default:
+                break;
+        }
+
+        key = result.key;
+        return result;
+    };
+
+    Pointer result = copy(root);
+
+    while (!frames.empty()) {
+        Frame frame = frames.back();
+
+        if (frame.Old.type == Type::OBJECT) {
+            const object_t & object = other._objects[frame.Old.key];
+
+            if (frame.Next == object.size()) {
+                frames.pop_back();
+                continue;
+            }
+
+            ++frames.back().Next;
+
+            // May push a frame and grow the pools
+            Pointer value = copy(object.values()[frame.Next]);
+            Object(frame.New.key).add(object.keys()[frame.Next], value);
+        }
+        else {
+            const list_t & list = other._lists[frame.Old.key];
+
+            if (frame.Next == list.size()) {
+                frames.pop_back();
+                continue;
+            }
+
+            ++frames.back().Next;
+            Pointer value = copy(list[frame.Next]);
+            List(frame.New.key).push_back(value);
+        }
+    }
+
+    return result;
+}
+
+Json::Pointer
+Json::Machine::Copy(const Json::Machine & other, Pointer value) {
+    std::unordered_map<uint64_t, key_t> copied;
+
+    return CopyFrom(other, value, [&](Pointer value) -> key_t & {
+        auto id = ((uint64_t)value.type << 32) | (uint32_t)value.key;
+        return copied.emplace(id, -1).first->second;
+    });
+}
+
+size_t
+Json::Machine::Compact() {
+    size_t before = Stats().Total.BytesReserved;
+
+    Machine compact;
+    compact.SetInterning(_interning);
+    compact._growths = _growths;
+
+    if (!_objects.empty()) {
+        // New key of each value already copied, by type, or -1
+        std::vector<key_t> copied[Type::NIL] = {
+            std::vector<key_t>(StringCount(), -1),
+            std::vector<key_t>(_integers.size(), -1),
+            std::vector<key_t>(_floats.size(), -1),
+            std::vector<key_t>(_booleans.size(), -1),
+            std::vector<key_t>(_objects.size(), -1),
+            std::vector<key_t>(_lists.size(), -1)
+        };
+
+        key_t root = _start < 0 ? (key_t)_objects.size() - 1 : _start;
+
+        compact.CopyFrom(*this, Pointer { Type::OBJECT, root }, [&](Pointer value) -> key_t & {
+            return copied[value.type][value.key];
+        });
+
+        compact.SetStartingObject(0);
+    }
+
+    compact._strings.shrink_to_fit();
+    compact._string_slots.shrink_to_fit();
+    compact._interned.shrink_to_fit();
+    compact._string_heap.shrink_to_fit();
+    compact._integers.shrink_to_fit();
+    compact._floats.shrink_to_fit();
+    compact._raw_numbers.shrink_to_fit();
+    compact._number_text.shrink_to_fit();
+    compact._raw_integers.shrink_to_fit();
+    compact._raw_floats.shrink_to_fit();
+    compact._lists.shrink_to_fit();
+    compact._objects.shrink_to_fit();
+
+    for (auto & list : compact._lists)
+        list.shrink_to_fit();
+
+    for (auto & object : compact._objects)
+        object.shrink_to_fit();
+
+    *this = std::move(compact);
+
+    size_t after = Stats().Total.BytesReserved;
+    return before > after ? before - after : 0;
+}
+
+void
+Json::Machine::Clear() {
+    // Documents with varying keys have filled the tree. Starting
+    // over frees it and lets the next ones share shapes again.
+    if (_root_shape->count() >= object_t::shape_t::MAX_SHAPES) {
+        _root_shape = std::make_shared<object_t::shape_t>();
+
+        for (auto & object : _spare_objects)
+            object.clear(_root_shape);
+    }
+
+    for (auto & value : _strings) {
+        value.clear();
+        _spare_strings.push_back(std::move(value));
+    }
+
+    for (auto & list : _lists) {
+        list.clear();
+        _spare_lists.push_back(std::move(list));
+    }
+
+    for (auto & object : _objects) {
+        object.clear(_root_shape);
+        _spare_objects.push_back(std::move(object));
+    }
+
+    _strings.clear();
+    _string_slots.clear();
+    _interned.clear();
+    _string_heap.clear();
+    std::fill(_intern_table.begin(), _intern_table.end(), -1);
+    _interned_values = 0;
+    _interned_value_bytes = 0;
+
+    _integers.clear();
+    _floats.clear();
+    _raw_numbers.clear();
+    _number_text.clear();
+    _raw_integers.clear();
+    _raw_floats.clear();
+    _booleans.clear();
+    _lists.clear();
+    _objects.clear();
+    _start = -1;
+    DropCaches();
+}
+
 Json::Pointer
 Json::Machine::NewObject() {
-    _objects.push_back(std::move(Json::object_t()));
+    Track(_objects, _growths.Objects);
+
+    if (_spare_objects.empty())
+        _objects.push_back(Json::object_t(_root_shape));
+    else {
+        _objects.push_back(std::move(_spare_objects.back()));
+        _spare_objects.pop_back();
+    }
+
     return Json::Pointer {
         Json::Type::OBJECT,
         (int)_objects.size() - 1
@@ -41,7 +317,15 @@ Json::Machine::NewObject() {
 
 Json::Pointer
 Json::Machine::NewList() {
-    _lists.push_back(std::move(Json::list_t()));
+    Track(_lists, _growths.Lists);
+
+    if (_spare_lists.empty())
+        _lists.push_back(std::move(Json::list_t()));
+    else {
+        _lists.push_back(std::move(_spare_lists.back()));
+        _spare_lists.pop_back();
+    }
+
     return Json::Pointer {
         Json::Type::LIST,
         (int)_lists.size() - 1
@@ -51,6 +335,7 @@ Json::Machine::NewList() {
 #define DEFINE_JSONMACHINE_BUILDER(NAME, PARAM_TYPE, VECTOR, TYPE_SYMBOL) \
     Json::Pointer \
     Json::Machine::New##NAME(PARAM_TYPE value) { \
+        Track(VECTOR, _growths.NAME##s); \
         VECTOR.push_back(value); \
         return Json::Pointer { \
             TYPE_SYMBOL, \
@@ -58,7 +343,6 @@ Json::Machine::NewList() {
         }; \
     }
 
-DEFINE_JSONMACHINE_BUILDER(String, const std::string &, _strings, Json::Type::STRING)
 DEFINE_JSONMACHINE_BUILDER(Integer, int, _integers, Json::Type::INTEGER)
 DEFINE_JSONMACHINE_BUILDER(Float, float, _floats, Json::Type::FLOAT)
 DEFINE_JSONMACHINE_BUILDER(Boolean, bool, _booleans, Json::Type::BOOLEAN)
@@ -67,18 +351,48 @@ DEFINE_JSONMACHINE_BUILDER(Boolean, bool, _booleans, Json::Type::BOOLEAN)
 #define DEFINE_JSONMACHINE_GETTER(RETURN, NAME, RESOURCE) \
     RETURN & \
     Json::Machine::NAME(key_t key) { \
+        DropCaches(); \
         return RESOURCE[key]; \
     }
 
 DEFINE_JSONMACHINE_GETTER(Json::object_t, Object, _objects)
 DEFINE_JSONMACHINE_GETTER(Json::list_t, List, _lists)
-DEFINE_JSONMACHINE_GETTER(std::string, String, _strings)
-DEFINE_JSONMACHINE_GETTER(int, Integer, _integers)
-DEFINE_JSONMACHINE_GETTER(float, Float, _floats)
 #undef DEFINE_JSONMACHINE_GETTER
 
+std::string &
+Json::Machine::String(key_t key) {
+    DropCaches();
+
+    if (_string_slots.empty())
+        return _strings[key];
+
+    key_t & slot = _string_slots[key];
+
+    if (slot >= 0) {
+        _strings.emplace_back(InternedText(slot));
+        slot = -(key_t)_strings.size();
+    }
+
+    return _strings[-slot - 1];
+}
+
+int &
+Json::Machine::Integer(key_t key) {
+    DropCaches();
+    Convert(Type::INTEGER, key);
+    return _integers[key];
+}
+
+float &
+Json::Machine::Float(key_t key) {
+    DropCaches();
+    Convert(Type::FLOAT, key);
+    return _floats[key];
+}
+
 void
 Json::Machine::SetBoolean(key_t key, bool value) {
+    DropCaches();
     _booleans.set((size_t)key, value);
 }
 
@@ -90,16 +404,346 @@ Json::Machine::SetBoolean(key_t key, bool value) {
 
 DEFINE_JSONMACHINE_CONST_GETTER(Json::object_t, Object, _objects)
 DEFINE_JSONMACHINE_CONST_GETTER(Json::list_t, List, _lists)
-DEFINE_JSONMACHINE_CONST_GETTER(std::string, String, _strings)
-DEFINE_JSONMACHINE_CONST_GETTER(int, Integer, _integers)
-DEFINE_JSONMACHINE_CONST_GETTER(float, Float, _floats)
 #undef DEFINE_JSONMACHINE_GETTER
 
+std::string_view
+Json::Machine::String(key_t key) const {
+    if (_string_slots.empty())
+        return _strings.at(key);
+
+    key_t slot = _string_slots.at(key);
+
+    return slot >= 0
+        ? InternedText(slot)
+        : std::string_view(_strings[-slot - 1]);
+}
+
+const int &
+Json::Machine::Integer(key_t key) const {
+    Convert(Type::INTEGER, key);
+    return _integers.at(key);
+}
+
+const float &
+Json::Machine::Float(key_t key) const {
+    Convert(Type::FLOAT, key);
+    return _floats.at(key);
+}
+
 bool
 Json::Machine::Boolean(key_t key) const {
     return _booleans[(size_t)key];
 }
 
+Json::Pointer
+Json::Machine::NewString(const std::string & value) {
+    return AddString(value);
+}
+
+Json::Pointer
+Json::Machine::AddString(std::string_view value) {
+    if (_interning) {
+        Track(_string_slots, _growths.Strings);
+        _string_slots.push_back(Intern(value));
+        ++_interned_values;
+        _interned_value_bytes += value.size();
+    }
+    else {
+        Track(_strings, _growths.Strings);
+
+        if (_spare_strings.empty())
+            _strings.emplace_back(value);
+        else {
+            _strings.push_back(std::move(_spare_strings.back()));
+            _spare_strings.pop_back();
+            _strings.back().assign(value.data(), value.size());
+        }
+
+        if (!_string_slots.empty())
+            _string_slots.push_back(-(key_t)_strings.size());
+    }
+
+    return Json::Pointer {
+        Json::Type::STRING,
+        StringCount() - 1
+    };
+}
+
+std::string_view
+Json::Machine::InternedText(key_t id) const {
+    auto & entry = _interned[id];
+    return std::string_view(_string_heap.data() + entry.Offset, entry.Length);
+}
+
+void
+Json::Machine::Rehash(size_t size) {
+    _intern_table.assign(size, -1);
+    size_t mask = size - 1;
+
+    for (key_t id = 0; id < (key_t)_interned.size(); ++id) {
+        size_t i = _interned[id].Hash & mask;
+
+        while (_intern_table[i] >= 0)
+            i = (i + 1) & mask;
+
+        _intern_table[i] = id;
+    }
+}
+
+Json::key_t
+Json::Machine::Intern(std::string_view text) {
+    // Keeps the table at most half full
+    if ((_interned.size() + 1) * 2 > _intern_table.size())
+        Rehash(std::max((size_t)16, _intern_table.size() * 2));
+
+    size_t hash = std::hash<std::string_view>()(text);
+    size_t mask = _intern_table.size() - 1;
+
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        key_t id = _intern_table[i];
+
+        if (id < 0) {
+            id = (key_t)_interned.size();
+            _interned.push_back(InternedString { _string_heap.size(), text.size(), hash });
+            _string_heap.append(text);
+            _intern_table[i] = id;
+            return id;
+        }
+
+        if (_interned[id].Hash == hash && InternedText(id) == text)
+            return id;
+    }
+}
+
+void
+Json::Machine::SetInterning(bool interning) {
+    // Strings added so far keep their own copies
+    if (interning && _string_slots.empty())
+        for (key_t i = 0; i < (key_t)_strings.size(); ++i)
+            _string_slots.push_back(-i - 1);
+
+    _interning = interning;
+}
+
+bool
+Json::Machine::Interning() const {
+    return _interning;
+}
+
+Json::key_t
+Json::Machine::StringCount() const {
+    return _string_slots.empty()
+        ? (key_t)_strings.size()
+        : (key_t)_string_slots.size();
+}
+
+Json::key_t
+Json::Machine::IntegerCount() const {
+    return (key_t)_integers.size();
+}
+
+Json::key_t
+Json::Machine::FloatCount() const {
+    return (key_t)_floats.size();
+}
+
+Json::key_t
+Json::Machine::BooleanCount() const {
+    return (key_t)_booleans.size();
+}
+
+Json::key_t
+Json::Machine::ListCount() const {
+    return (key_t)_lists.size();
+}
+
+Json::key_t
+Json::Machine::ObjectCount() const {
+    return (key_t)_objects.size();
+}
+
+size_t
+Json::Machine::InternedBytesSaved() const {
+    size_t separate = _interned_values * sizeof(std::string)
+        + _interned_value_bytes;
+
+    size_t pooled = _string_heap.size()
+        + _interned.size() * sizeof(InternedString)
+        + _intern_table.size() * sizeof(key_t)
+        + _interned_values * sizeof(key_t);
+
+    return separate > pooled ? separate - pooled : 0;
+}
+
+namespace {
+    // Whether integral text converts to an int without overflow.
+    // Text of fewer than 10 digits always does.
+    bool
+    FitsInteger(const std::string & text) {
+        size_t digits = text.size() - (!text.empty() && text[0] == '-');
+        int value = 0;
+
+        return digits < 10
+            || Homonumeric::Raw(text.data(), (int)text.size())
+                .AsInteger(value);
+    }
+}
+
+Json::Pointer
+Json::Machine::NewNumber(const std::string & text) {
+    // Integral text out of the range of an int is kept as a float
+    bool integral = Homonumeric::Classify(text.data(), (int)text.size())
+            == Homonumeric::Class::INTEGRAL
+        && FitsInteger(text);
+
+    auto & pool = integral ? _raw_integers : _raw_floats;
+    key_t key = integral ? (key_t)_integers.size() : (key_t)_floats.size();
+
+    if (integral) {
+        Track(_integers, _growths.Integers);
+        _integers.push_back(0);
+    }
+    else {
+        Track(_floats, _growths.Floats);
+        _floats.push_back(0);
+    }
+
+    pool.resize(key, -1);
+    pool.push_back((key_t)_raw_numbers.size());
+    _raw_numbers.push_back(RawNumber { _number_text.size(), text.size(), false });
+    _number_text.append(text);
+
+    return Pointer {
+        integral ? Type::INTEGER : Type::FLOAT,
+        key
+    };
+}
+
+void
+Json::Machine::Convert(Type type, key_t key) const {
+    auto & pool = type == Type::INTEGER ? _raw_integers : _raw_floats;
+
+    if (key < 0 || (size_t)key >= pool.size() || pool[key] < 0)
+        return;
+
+    auto & raw = _raw_numbers[pool[key]];
+
+    if (raw.Converted)
+        return;
+
+    auto number = Homonumeric::Raw(
+        _number_text.data() + raw.Offset,
+        (int)raw.Length
+    );
+
+    if (type == Type::INTEGER)
+        number.AsInteger(_integers[key]);
+    else
+        number.AsFloat(_floats[key]);
+
+    raw.Converted = true;
+}
+
+void
+Json::Machine::ConvertNumbers() const {
+    for (key_t key = 0; key < (key_t)_raw_integers.size(); ++key)
+        Convert(Type::INTEGER, key);
+
+    for (key_t key = 0; key < (key_t)_raw_floats.size(); ++key)
+        Convert(Type::FLOAT, key);
+}
+
+void
+Json::Machine::DropCaches() {
+    _list_hashes.clear();
+    _object_hashes.clear();
+    _indexes.Clear();
+}
+
+uint64_t
+Json::Machine::Hash(Pointer value) const {
+    // Lists and objects made since the last hash start at 0
+    if (_list_hashes.size() != _lists.size())
+        _list_hashes.resize(_lists.size(), 0);
+
+    if (_object_hashes.size() != _objects.size())
+        _object_hashes.resize(_objects.size(), 0);
+
+    return HashValue(*this, value, [&](Pointer container) -> uint64_t & {
+        return container.type == Type::LIST
+            ? _list_hashes[container.key]
+            : _object_hashes[container.key];
+    });
+}
+
+void
+Json::Machine::ComputeHashes() const {
+    for (key_t key = 0; key < (key_t)_lists.size(); ++key)
+        Hash(Pointer { Type::LIST, key });
+
+    for (key_t key = 0; key < (key_t)_objects.size(); ++key)
+        Hash(Pointer { Type::OBJECT, key });
+}
+
+const Json::FieldIndex &
+Json::Machine::HashIndex(key_t list, const std::string & field) const {
+    return _indexes.Get(list, field, false, [&](FieldIndex & index) {
+        IndexHashes(index, *this, list, field);
+    });
+}
+
+const Json::FieldIndex &
+Json::Machine::OrderedIndex(key_t list, const std::string & field) const {
+    return _indexes.Get(list, field, true, [&](FieldIndex & index) {
+        IndexNumbers(index, *this, list, field);
+    });
+}
+
+std::string_view
+Json::Machine::SourceText(Pointer pointer) const {
+    const std::vector<key_t> * pool = nullptr;
+
+    switch (pointer.type) {
+        case Type::INTEGER:
+            pool = &_raw_integers;
+            break;
+        case Type::FLOAT:
+            pool = &_raw_floats;
+            break;
+        default:
+            return std::string_view();
+    }
+
+    if (pointer.key < 0
+        || (size_t)pointer.key >= pool->size()
+        || (*pool)[pointer.key] < 0
+    )
+        return std::string_view();
+
+    auto & raw = _raw_numbers[(*pool)[pointer.key]];
+    return std::string_view(_number_text.data() + raw.Offset, raw.Length);
+}
+
+void
+Json::Machine::SetInteger(key_t key, int value) {
+    DropCaches();
+
+    if ((size_t)key < _raw_integers.size())
+        _raw_integers[key] = -1;
+
+    _integers[key] = value;
+}
+
+void
+Json::Machine::SetFloat(key_t key, float value) {
+    DropCaches();
+
+    if ((size_t)key < _raw_floats.size())
+        _raw_floats[key] = -1;
+
+    _floats[key] = value;
+}
+
 std::string
 Json::Machine::ToString() const {
     std::ostringstream oss;
@@ -110,9 +754,9 @@ Json::Machine::ToString() const {
         oss << "  " << i << ":\n";
         auto & object = _objects[i];
 
-        for (int j = 0; j < object.keys().size(); ++j) {
-            auto & key = object.keys().at(j);
-            auto value = object.at(key);
+        for (size_t j = 0; j < object.size(); ++j) {
+            auto & key = object.keys()[j];
+            auto value = object.values()[j];
 
             oss << "    Pair " << j << ":\n"
                 << "      Key: [" << key << "]\n"
@@ -128,7 +772,7 @@ Json::Machine::ToString() const {
         oss << "  " << i << ":\n";
         auto & list = _lists[i];
 
-        for (auto & value : list) {
+        for (Pointer value : list) {
             oss << "    Type: " << Json::ToString(value.type) << '\n'
                 << "    Index: " << value.key << '\n';
         }
@@ -136,18 +780,18 @@ Json::Machine::ToString() const {
 
     oss << "Strings:\n";
 
-    for (int i = 0; i < _strings.size(); ++i)
-        oss << "  " << i << ": [" << _strings[i] << "]\n";
+    for (int i = 0; i < StringCount(); ++i)
+        oss << "  " << i << ": [" << String(i) << "]\n";
 
     oss << "Integers:\n";
 
     for (int i = 0; i < _integers.size(); ++i)
-        oss << "  " << i << ": [" << _integers[i] << "]\n";
+        oss << "  " << i << ": [" << Integer(i) << "]\n";
 
     oss << "Floats:\n";
 
     for (int i = 0; i < _floats.size(); ++i)
-        oss << "  " << i << ": [" << _floats[i] << "]\n";
+        oss << "  " << i << ": [" << Float(i) << "]\n";
 
     oss << "Booleans:\n";
 
@@ -172,6 +816,16 @@ Json::Machine::ToString() const {
             } \
     )
 
+const typename Json::Machine::ResultSet<Json::Machine const *>
+Json::Machine::GetResultSet(Pointer value) const {
+    return ResultSet<Json::Machine const *>(this, value);
+}
+
+typename Json::Machine::ResultSet<Json::Machine *>
+Json::Machine::GetResultSet(Pointer value) {
+    return ResultSet<Json::Machine *>(this, value);
+}
+
 typename Json::Machine::ResultSet<Json::Machine *>
 Json::Machine::GetResultSet() {
     return BLOCK_JSONMACHINE_GETRESULTSET(Json::Machine *, _start);
@@ -193,3 +847,324 @@ Json::Machine::GetResultSet(key_t start) const {
 }
 
 #undef BLOCK_JSONMACHINE_GETRESULTSET
+
+Json::Pointer
+Json::Machine::Merge(const Json::Machine & other) {
+    auto root = other.GetResultSet()._pointer;
+    return Append(other).Rebase(root);
+}
+
+Json::Pointer
+Json::Offsets::Rebase(Json::Pointer pointer) const {
+    switch (pointer.type) {
+        case Type::STRING:
+            pointer.key += Strings;
+            break;
+        case Type::INTEGER:
+            pointer.key += Integers;
+            break;
+        case Type::FLOAT:
+            pointer.key += Floats;
+            break;
+        case Type::BOOLEAN:
+            pointer.key += Booleans;
+            break;
+        case Type::LIST:
+            pointer.key += Lists;
+            break;
+        case Type::OBJECT:
+            pointer.key += Objects;
+            break;
+        default:
+            break;
+    }
+
+    return pointer;
+}
+
+Json::Offsets
+Json::Machine::Append(const Json::Machine & other) {
+    Offsets offsets;
+    offsets.Strings = StringCount();
+    offsets.Integers = (key_t)_integers.size();
+    offsets.Floats = (key_t)_floats.size();
+    offsets.Booleans = (key_t)_booleans.size();
+    offsets.Lists = (key_t)_lists.size();
+    offsets.Objects = (key_t)_objects.size();
+
+    key_t rawOffset = (key_t)_raw_numbers.size();
+    size_t textOffset = _number_text.size();
+
+    for (auto raw : other._raw_numbers) {
+        raw.Offset = raw.Offset + textOffset;
+        _raw_numbers.push_back(raw);
+    }
+
+    _number_text.append(other._number_text);
+
+    if (!other._raw_integers.empty())
+        _raw_integers.resize(offsets.Integers, -1);
+
+    for (auto raw : other._raw_integers)
+        _raw_integers.push_back(raw < 0 ? raw : raw + rawOffset);
+
+    if (!other._raw_floats.empty())
+        _raw_floats.resize(offsets.Floats, -1);
+
+    for (auto raw : other._raw_floats)
+        _raw_floats.push_back(raw < 0 ? raw : raw + rawOffset);
+
+    if (_string_slots.empty() && other._string_slots.empty())
+        _strings.insert(_strings.end(), other._strings.begin(), other._strings.end());
+    else
+        for (key_t i = 0; i < other.StringCount(); ++i)
+            AddString(other.String(i));
+
+    _integers.insert(_integers.end(), other._integers.begin(), other._integers.end());
+    _floats.insert(_floats.end(), other._floats.begin(), other._floats.end());
+
+    _booleans.append(other._booleans);
+
+    _lists.reserve(_lists.size() + other._lists.size());
+
+    for (auto & otherList : other._lists) {
+        _lists.push_back(otherList);
+        auto & list = _lists.back();
+
+        for (size_t i = 0; i < list.size(); ++i)
+            list.set(i, offsets.Rebase(list[i]));
+    }
+
+    _objects.reserve(_objects.size() + other._objects.size());
+
+    // Each shape of the other Machine is found in this one once
+    std::unordered_map<
+        const object_t::shape_t *,
+        std::shared_ptr<object_t::shape_t>
+    > shapes;
+
+    for (auto & otherObject : other._objects) {
+        auto & shape = shapes[otherObject.shape().get()];
+
+        if (!shape) {
+            if (otherObject.shape()->dictionary())
+                shape = otherObject.shape()->detach();
+            else {
+                shape = _root_shape;
+
+                for (auto & key : otherObject.keys()) {
+                    auto next = shape->dictionary()
+                        ? nullptr
+                        : shape->transition(key);
+
+                    if (next)
+                        shape = next;
+                    else {
+                        // Past the limits of this Machine's tree
+                        if (!shape->dictionary())
+                            shape = shape->detach();
+
+                        shape->push(key);
+                    }
+                }
+            }
+        }
+
+        PointerList values;
+        values.reserve(otherObject.size());
+
+        for (auto value : otherObject.values())
+            values.push_back(offsets.Rebase(value));
+
+        _objects.push_back(object_t(shape, std::move(values)));
+    }
+
+    return offsets;
+}
+
+namespace {
+    // Bytes of the heap buffer of a string, if it has one
+    size_t
+    HeapBytes(const std::string & value) {
+        static const size_t SMALL_CAPACITY = std::string().capacity();
+
+        return value.capacity() > SMALL_CAPACITY
+            ? value.capacity() + 1
+            : 0;
+    }
+
+    template <typename T>
+    Json::PoolStats
+    VectorStats(const std::vector<T> & pool) {
+        Json::PoolStats stats;
+        stats.Count = pool.size();
+        stats.BytesUsed = pool.size() * sizeof(T);
+        stats.BytesReserved = pool.capacity() * sizeof(T);
+        return stats;
+    }
+}
+
+Json::PoolStats &
+Json::PoolStats::operator+=(const Json::PoolStats & other) {
+    Count = Count + other.Count;
+    BytesUsed = BytesUsed + other.BytesUsed;
+    BytesReserved = BytesReserved + other.BytesReserved;
+    StringBytes = StringBytes + other.StringBytes;
+    Growths = Growths + other.Growths;
+    return *this;
+}
+
+std::string
+Json::MachineStats::ToString() const {
+    std::ostringstream oss;
+
+    auto line = [&](const char * name, const PoolStats & pool) {
+        oss << name << ": "
+            << pool.Count << " elements, "
+            << pool.BytesUsed << " bytes used, "
+            << pool.BytesReserved << " bytes reserved, "
+            << pool.StringBytes << " string bytes, "
+            << pool.Growths << " growths\n";
+    };
+
+    line("Strings", Strings);
+    line("Integers", Integers);
+    line("Floats", Floats);
+    line("Booleans", Booleans);
+    line("Lists", Lists);
+    line("Objects", Objects);
+    line("RawNumbers", RawNumbers);
+    line("Total", Total);
+    return oss.str();
+}
+
+Json::MachineStats
+Json::Machine::Stats() const {
+    MachineStats stats;
+
+    stats.Strings = VectorStats(_strings);
+    stats.Strings.Count = StringCount();
+
+    for (auto & value : _strings) {
+        size_t heap = HeapBytes(value);
+        stats.Strings.BytesUsed += heap ? value.size() + 1 : 0;
+        stats.Strings.BytesReserved += heap;
+        stats.Strings.StringBytes += heap;
+    }
+
+    for (auto pool : {
+        VectorStats(_string_slots),
+        VectorStats(_interned),
+        VectorStats(_intern_table)
+    }) {
+        stats.Strings.BytesUsed += pool.BytesUsed;
+        stats.Strings.BytesReserved += pool.BytesReserved;
+    }
+
+    stats.Strings.BytesUsed += _string_heap.size();
+    stats.Strings.BytesReserved += HeapBytes(_string_heap);
+    stats.Strings.StringBytes += HeapBytes(_string_heap);
+
+    // Spares left by Clear hold capacity but no values
+    stats.Strings.BytesReserved += VectorStats(_spare_strings).BytesReserved;
+
+    for (auto & value : _spare_strings) {
+        stats.Strings.BytesReserved += HeapBytes(value);
+        stats.Strings.StringBytes += HeapBytes(value);
+    }
+
+    stats.Integers = VectorStats(_integers);
+    stats.Integers.BytesUsed += _raw_integers.size() * sizeof(key_t);
+    stats.Integers.BytesReserved += _raw_integers.capacity() * sizeof(key_t);
+
+    stats.Floats = VectorStats(_floats);
+    stats.Floats.BytesUsed += _raw_floats.size() * sizeof(key_t);
+    stats.Floats.BytesReserved += _raw_floats.capacity() * sizeof(key_t);
+
+    stats.Booleans.Count = _booleans.size();
+    stats.Booleans.BytesUsed = (_booleans.size() + CHAR_BIT - 1) / CHAR_BIT;
+    stats.Booleans.BytesReserved = _booleans.capacity() / CHAR_BIT;
+
+    stats.Lists = VectorStats(_lists);
+
+    for (auto & list : _lists) {
+        stats.Lists.BytesUsed += list.bytes();
+        stats.Lists.BytesReserved += list.reserved();
+    }
+
+    stats.Lists.BytesReserved += VectorStats(_spare_lists).BytesReserved;
+
+    for (auto & list : _spare_lists)
+        stats.Lists.BytesReserved += list.reserved();
+
+    stats.Objects = VectorStats(_objects);
+
+    auto addShape = [&](const object_t::shape_t & shape) {
+        // Nodes of the transition map, roughly
+        size_t transitions = shape.transitions().bucket_count() * sizeof(void *)
+            + shape.transitions().size() * (
+                sizeof(std::string)
+                + sizeof(std::shared_ptr<object_t::shape_t>)
+                + 2 * sizeof(void *)
+            );
+
+        stats.Objects.BytesUsed += sizeof shape + shape.bytes() + transitions;
+        stats.Objects.BytesReserved += sizeof shape + shape.bytes() + transitions;
+
+        for (auto & key : shape.keys()) {
+            stats.Objects.BytesReserved += HeapBytes(key);
+            stats.Objects.StringBytes += HeapBytes(key);
+        }
+    };
+
+    for (auto & object : _objects) {
+        stats.Objects.BytesUsed += object.values().bytes();
+        stats.Objects.BytesReserved += object.values().reserved();
+
+        if (object.shape()->dictionary())
+            addShape(*object.shape());
+    }
+
+    // Spares share the root shape
+    stats.Objects.BytesReserved += VectorStats(_spare_objects).BytesReserved;
+
+    for (auto & object : _spare_objects)
+        stats.Objects.BytesReserved += object.values().reserved();
+
+    // Shared shapes, counted once each
+    std::vector<const object_t::shape_t *> shapes = { _root_shape.get() };
+
+    while (!shapes.empty()) {
+        auto shape = shapes.back();
+        shapes.pop_back();
+        addShape(*shape);
+
+        for (auto & transition : shape->transitions())
+            shapes.push_back(transition.second.get());
+    }
+
+    stats.Strings.Growths = _growths.Strings;
+    stats.Integers.Growths = _growths.Integers;
+    stats.Floats.Growths = _growths.Floats;
+    stats.Booleans.Growths = _growths.Booleans;
+    stats.Lists.Growths = _growths.Lists;
+    stats.Objects.Growths = _growths.Objects;
+
+    stats.RawNumbers = VectorStats(_raw_numbers);
+    stats.RawNumbers.BytesUsed += _number_text.size();
+    stats.RawNumbers.BytesReserved += HeapBytes(_number_text);
+    stats.RawNumbers.StringBytes += HeapBytes(_number_text);
+
+    for (auto & pool : {
+        stats.Strings,
+        stats.Integers,
+        stats.Floats,
+        stats.Booleans,
+        stats.Lists,
+        stats.Objects,
+        stats.RawNumbers
+    })
+        stats.Total += pool;
+
+    return stats;
+}
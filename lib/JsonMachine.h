@@ -2,10 +2,20 @@
 #ifndef _JSONMACHINE_H
 #define _JSONMACHINE_H
 
+#include "Homonumeric.h"
 #include "VectorBitset.h"
+#include "JsonColumns.h"
+#include "JsonIndex.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <numeric>
+#include <stdexcept>
 #include <sstream>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 
 // **note: sfinae
 //   link: https://en.wikipedia.org/wiki/Substitution_failure_is_not_an_error#:~:text=Substitution%20failure%20is%20not%20an%20error%20(SFINAE)%20refers%20to%20a,to%20describe%20related%20programming%20techniques.
@@ -33,28 +43,519 @@ namespace Json {
         key_t key = 0;
     };
 
-    typedef std::vector<Pointer>
+    // Sequence of Pointers packed into 32-bit words: the key shifted
+    // left over a 3-bit type tag. Once a key does not fit in the
+    // remaining 29 bits, the whole list escapes to two words per
+    // Pointer, type then key.
+    //
+    // Elements read as Pointer values. The non-const operator[]
+    // returns a proxy that can be assigned a Pointer.
+    class PointerList {
+        public:
+            static const int TAG_BITS = 3;
+            static const uint32_t TAG_MASK = (1U << TAG_BITS) - 1;
+            static const key_t MAX_PACKED_KEY = (key_t)(0xFFFFFFFFU >> TAG_BITS);
+
+            class reference {
+                private:
+                    PointerList * _list;
+                    size_t _index;
+                public:
+                    reference(PointerList * list, size_t index):
+                        _list(list),
+                        _index(index) {}
+
+                    operator Pointer() const {
+                        return _list->get(_index);
+                    }
+
+                    reference &
+                    operator=(Pointer value) {
+                        _list->set(_index, value);
+                        return *this;
+                    }
+            };
+
+            class const_iterator {
+                private:
+                    const PointerList * _list;
+                    size_t _index;
+                public:
+                    const_iterator(const PointerList * list, size_t index):
+                        _list(list),
+                        _index(index) {}
+
+                    Pointer
+                    operator*() const {
+                        return _list->get(_index);
+                    }
+
+                    const_iterator &
+                    operator++() {
+                        ++_index;
+                        return *this;
+                    }
+
+                    bool
+                    operator!=(const const_iterator & other) const {
+                        return _index != other._index;
+                    }
+            };
+        private:
+            std::vector<uint32_t>
+            _words;
+
+            bool
+            _wide = false;
+
+            void
+            widen() {
+                std::vector<uint32_t> words;
+                words.reserve(_words.size() * 2);
+
+                for (uint32_t word : _words) {
+                    words.push_back(word & TAG_MASK);
+                    words.push_back(word >> TAG_BITS);
+                }
+
+                _words = std::move(words);
+                _wide = true;
+            }
+
+            Pointer
+            get(size_t index) const {
+                if (_wide)
+                    return Pointer {
+                        (Type)_words[2 * index],
+                        (key_t)_words[2 * index + 1]
+                    };
+
+                return unpack(_words[index]);
+            }
+        public:
+            static bool
+            packable(Pointer value) {
+                return value.key >= 0 && value.key <= MAX_PACKED_KEY;
+            }
+
+            static uint32_t
+            pack(Pointer value) {
+                return ((uint32_t)value.key << TAG_BITS) | (uint32_t)value.type;
+            }
+
+            static Pointer
+            unpack(uint32_t word) {
+                return Pointer { (Type)(word & TAG_MASK), (key_t)(word >> TAG_BITS) };
+            }
+
+            size_t
+            size() const {
+                return _wide ? _words.size() / 2 : _words.size();
+            }
+
+            bool
+            empty() const {
+                return _words.empty();
+            }
+
+            // Two words per Pointer
+            bool
+            wide() const {
+                return _wide;
+            }
+
+            // Bytes held by the elements
+            size_t
+            bytes() const {
+                return _words.size() * sizeof(uint32_t);
+            }
+
+            size_t
+            reserved() const {
+                return _words.capacity() * sizeof(uint32_t);
+            }
+
+            void
+            reserve(size_t size) {
+                _words.reserve(size);
+            }
+
+            void
+            clear() {
+                _words.clear();
+                _wide = false;
+            }
+
+            void
+            shrink_to_fit() {
+                _words.shrink_to_fit();
+            }
+
+            void
+            push_back(Pointer value) {
+                if (!_wide && !packable(value))
+                    widen();
+
+                if (_wide) {
+                    _words.push_back((uint32_t)value.type);
+                    _words.push_back((uint32_t)value.key);
+                }
+                else
+                    _words.push_back(pack(value));
+            }
+
+            void
+            set(size_t index, Pointer value) {
+                if (!_wide && !packable(value))
+                    widen();
+
+                if (_wide) {
+                    _words[2 * index] = (uint32_t)value.type;
+                    _words[2 * index + 1] = (uint32_t)value.key;
+                }
+                else
+                    _words[index] = pack(value);
+            }
+
+            // Before the element at the index, or at the end
+            void
+            insert(size_t index, Pointer value) {
+                if (!_wide && !packable(value))
+                    widen();
+
+                if (_wide)
+                    _words.insert(
+                        _words.begin() + 2 * index,
+                        { (uint32_t)value.type, (uint32_t)value.key }
+                    );
+                else
+                    _words.insert(_words.begin() + index, pack(value));
+            }
+
+            void
+            erase(size_t index) {
+                if (_wide)
+                    _words.erase(
+                        _words.begin() + 2 * index,
+                        _words.begin() + 2 * index + 2
+                    );
+                else
+                    _words.erase(_words.begin() + index);
+            }
+
+            Pointer
+            operator[](size_t index) const {
+                return get(index);
+            }
+
+            reference
+            operator[](size_t index) {
+                return reference(this, index);
+            }
+
+            Pointer
+            at(size_t index) const {
+                if (index >= size())
+                    throw std::out_of_range("PointerList::at");
+
+                return get(index);
+            }
+
+            const_iterator
+            begin() const {
+                return const_iterator(this, 0);
+            }
+
+            const_iterator
+            end() const {
+                return const_iterator(this, size());
+            }
+    };
+
+    typedef PointerList
     list_t;
 
+    // Ordered key set of an object, shared by every object that was
+    // given the same keys in the same order.
+    //
+    // Shapes form a tree: adding a key to an object moves it to a
+    // child of its shape, made on first use. Past MAX_SHARED_KEYS
+    // keys, an object gets a dictionary shape of its own that is
+    // added to in place. So does an object whose shape already has
+    // MAX_TRANSITIONS children, or whose tree already has MAX_SHAPES
+    // shapes, so that documents with ever-changing keys do not grow
+    // the tree without bound.
+    //
+    // Lookup scans the keys while there are at most INDEX_THRESHOLD
+    // of them. Past that, a shape keeps an open-addressing index of
+    // positions.
+    //
+    // Adding keys is not safe while another thread uses any object
+    // with a shape from the same tree.
     template <typename T>
-    class ObjectDefinition {
+    class ObjectShape {
+        public:
+            static const size_t INDEX_THRESHOLD = 8;
+            static const size_t MAX_SHARED_KEYS = 64;
+            static const size_t MAX_TRANSITIONS = 64;
+            static const size_t MAX_SHAPES = 4096;
         private:
-            std::unordered_map<T, Pointer>
-            _map;
-
             std::vector<T>
             _keys;
+
+            // Positions into _keys, -1 for an empty bucket. Empty
+            // while there are at most INDEX_THRESHOLD keys,
+            // otherwise at most half full and a power of two in size.
+            std::vector<int>
+            _index;
+
+            std::unordered_map<T, std::shared_ptr<ObjectShape>>
+            _transitions;
+
+            bool
+            _dictionary = false;
+
+            // Number of shapes in the tree, shared by all of them.
+            // Made by the root on its first transition.
+            std::shared_ptr<size_t>
+            _shapes;
+
+            size_t
+            bucket(const T & key) const {
+                return std::hash<T>()(key) & (_index.size() - 1);
+            }
+
+            void
+            insert(int position) {
+                size_t mask = _index.size() - 1;
+                size_t i = bucket(_keys[position]);
+
+                while (_index[i] >= 0)
+                    i = (i + 1) & mask;
+
+                _index[i] = position;
+            }
+
+            void
+            reindex() {
+                if (_keys.size() <= INDEX_THRESHOLD)
+                    return;
+
+                if (_keys.size() * 2 <= _index.size()) {
+                    insert((int)_keys.size() - 1);
+                    return;
+                }
+
+                rebuild();
+            }
+
+            void
+            rebuild() {
+                _index.clear();
+
+                if (_keys.size() <= INDEX_THRESHOLD)
+                    return;
+
+                size_t size = 32;
+
+                while (size < _keys.size() * 2)
+                    size = size * 2;
+
+                _index.assign(size, -1);
+
+                for (int i = 0; i < (int)_keys.size(); ++i)
+                    insert(i);
+            }
+        public:
+            virtual ~ObjectShape() = default;
+
+            size_t
+            size() const {
+                return _keys.size();
+            }
+
+            const std::vector<T> &
+            keys() const {
+                return _keys;
+            }
+
+            bool
+            dictionary() const {
+                return _dictionary;
+            }
+
+            const std::unordered_map<T, std::shared_ptr<ObjectShape>> &
+            transitions() const {
+                return _transitions;
+            }
+
+            // Shapes in the tree so far
+            size_t
+            count() const {
+                return _shapes ? *_shapes : 1;
+            }
+
+            // Bytes of the key and index vectors
+            size_t
+            bytes() const {
+                return _keys.capacity() * sizeof(T)
+                    + _index.capacity() * sizeof(int);
+            }
+
+            // Position of the key, or -1
+            int
+            find(const T & key) const {
+                if (_index.empty()) {
+                    for (int i = 0; i < (int)_keys.size(); ++i)
+                        if (_keys[i] == key)
+                            return i;
+
+                    return -1;
+                }
+
+                size_t mask = _index.size() - 1;
+
+                for (size_t i = bucket(key); _index[i] >= 0; i = (i + 1) & mask)
+                    if (_keys[_index[i]] == key)
+                        return _index[i];
+
+                return -1;
+            }
+
+            // Shared shape with one more key, or null past the limits
+            std::shared_ptr<ObjectShape>
+            transition(const T & key) {
+                auto found = _transitions.find(key);
+
+                if (found != _transitions.end())
+                    return found->second;
+
+                if (!_shapes)
+                    _shapes = std::make_shared<size_t>(1);
+
+                if (_transitions.size() >= MAX_TRANSITIONS
+                    || *_shapes >= MAX_SHAPES
+                )
+                    return nullptr;
+
+                auto next = std::make_shared<ObjectShape>();
+                next->_keys.reserve(_keys.size() + 1);
+                next->_keys = _keys;
+                next->_keys.push_back(key);
+                next->reindex();
+                next->_shapes = _shapes;
+                ++*_shapes;
+                _transitions.emplace(key, next);
+                return next;
+            }
+
+            // Unshared copy that keys can be added to in place
+            std::shared_ptr<ObjectShape>
+            detach() const {
+                auto copy = std::make_shared<ObjectShape>();
+                copy->_keys = _keys;
+                copy->_index = _index;
+                copy->_dictionary = true;
+                return copy;
+            }
+
+            // Dictionary shapes only
+            void
+            push(const T & key) {
+                _keys.push_back(key);
+                reindex();
+            }
+
+            // Dictionary shapes only
+            void
+            erase(int position) {
+                _keys.erase(_keys.begin() + position);
+                rebuild();
+            }
+    };
+
+    // Values of an object in the order of the keys of its shape
+    template <typename T>
+    class ObjectDefinition {
+        public:
+            typedef ObjectShape<T>
+            shape_t;
+        private:
+            std::shared_ptr<shape_t>
+            _shape;
+
+            PointerList
+            _values;
+
+            void
+            push(const T & key, Pointer value) {
+                std::shared_ptr<shape_t> next;
+
+                if (!_shape->dictionary()
+                    && _shape->size() < shape_t::MAX_SHARED_KEYS
+                )
+                    next = _shape->transition(key);
+
+                if (next)
+                    _shape = next;
+                else {
+                    // Copies of an object share its dictionary shape
+                    // until one of them adds a key
+                    if (!_shape->dictionary() || _shape.use_count() > 1)
+                        _shape = _shape->detach();
+
+                    _shape->push(key);
+                }
+
+                _values.push_back(value);
+            }
         public:
             virtual ~ObjectDefinition() = default;
+            ObjectDefinition(const ObjectDefinition &) = default;
+            ObjectDefinition(ObjectDefinition &&) = default;
+            ObjectDefinition & operator=(const ObjectDefinition &) = default;
+            ObjectDefinition & operator=(ObjectDefinition &&) = default;
+
+            // With a root shape of its own
+            ObjectDefinition():
+                _shape(std::make_shared<shape_t>()) {}
+
+            // Empty object under the given root shape
+            ObjectDefinition(std::shared_ptr<shape_t> root):
+                _shape(root) {}
+
+            ObjectDefinition(
+                std::shared_ptr<shape_t> shape,
+                PointerList && values
+            ):  _shape(shape),
+                _values(std::move(values)) {}
 
             size_t
             size() const {
-                return _map.size();
+                return _values.size();
+            }
+
+            void
+            reserve(size_t size) {
+                _values.reserve(size);
+            }
+
+            void
+            shrink_to_fit() {
+                _values.shrink_to_fit();
+            }
+
+            // Empties the object under the given root shape, keeping
+            // the capacity of its values
+            void
+            clear(std::shared_ptr<shape_t> root) {
+                _shape = root;
+                _values.clear();
             }
 
             bool
             hasKey(const T & key) const {
-                return _map.find(key) != _map.end();
+                return _shape->find(key) >= 0;
             }
 
             bool
@@ -62,15 +563,33 @@ namespace Json {
                 if (hasKey(key))
                     return false;
 
-                _map[key] = value;
-                _keys.push_back(key);
+                push(key, value);
+                return true;
+            }
+
+            // Moves the object to a dictionary shape of its own.
+            // Returns false for a missing key.
+            bool
+            erase(const T & key) {
+                int position = _shape->find(key);
+
+                if (position < 0)
+                    return false;
+
+                if (!_shape->dictionary() || _shape.use_count() > 1)
+                    _shape = _shape->detach();
+
+                _shape->erase(position);
+                _values.erase(position);
                 return true;
             }
 
             Pointer
             at(const T & key) const {
-                if (hasKey(key))
-                    return _map.at(key);
+                int position = _shape->find(key);
+
+                if (position >= 0)
+                    return _values[position];
 
                 return Pointer();
             }
@@ -80,20 +599,209 @@ namespace Json {
                 return at(key);
             }
 
-            Pointer &
+            // Adds a null value for a missing key
+            PointerList::reference
             operator[](const T & key) {
-                return _map[key];
+                int position = _shape->find(key);
+
+                if (position < 0) {
+                    push(key, Pointer());
+                    position = (int)_values.size() - 1;
+                }
+
+                return _values[position];
             }
 
-            const std::vector<std::string> &
+            const std::vector<T> &
             keys() const {
-                return _keys;
+                return _shape->keys();
+            }
+
+            const PointerList &
+            values() const {
+                return _values;
+            }
+
+            const std::shared_ptr<shape_t> &
+            shape() const {
+                return _shape;
+            }
+    };
+
+    // Inline cache for looking up one key in many objects. The
+    // position of the key is looked up again only when an object has
+    // a different shape from the last one, so records of the same
+    // layout cost one comparison each.
+    template <typename T>
+    class KeyCache {
+        private:
+            T _key;
+
+            std::shared_ptr<const ObjectShape<T>>
+            _shape;
+
+            int
+            _position = -1;
+        public:
+            KeyCache(const T & key):
+                _key(key) {}
+
+            virtual ~KeyCache() = default;
+
+            const T &
+            key() const {
+                return _key;
+            }
+
+            // Null for a missing key
+            Pointer
+            at(const ObjectDefinition<T> & object) {
+                auto & shape = object.shape();
+
+                if (shape != _shape) {
+                    int position = shape->find(_key);
+
+                    // A dictionary shape can still gain the key
+                    if (shape->dictionary())
+                        return position >= 0
+                            ? object.values()[position]
+                            : Pointer();
+
+                    _shape = shape;
+                    _position = position;
+                }
+
+                return _position >= 0
+                    ? object.values()[_position]
+                    : Pointer();
+            }
+
+            // Any other kind of object, such as a MappedObject, by
+            // its own lookup
+            template <typename Object_Type>
+            Pointer
+            at(const Object_Type & object) {
+                return object.at(_key);
             }
     };
 
     typedef ObjectDefinition<std::string>
     object_t;
 
+    typedef KeyCache<std::string>
+    key_cache_t;
+
+    // Number of values of each kind
+    struct PoolSizes {
+        size_t Strings = 0;
+        size_t Integers = 0;
+        size_t Floats = 0;
+        size_t Booleans = 0;
+        size_t Lists = 0;
+        size_t Objects = 0;
+    };
+
+    // Sizes of one pool of a Machine
+    struct PoolStats {
+        size_t Count = 0;
+
+        // Bytes taken by the elements, and by the capacity held for
+        // them, including any memory they point to
+        size_t BytesUsed = 0;
+        size_t BytesReserved = 0;
+
+        // Part of BytesReserved in string buffers on the heap.
+        // Strings short enough to live inside a std::string add
+        // nothing.
+        size_t StringBytes = 0;
+
+        // Times the pool had to grow to add a value, counting its
+        // first allocation
+        size_t Growths = 0;
+
+        PoolStats & operator+=(const PoolStats &);
+    };
+
+    // BytesReserved includes the strings, lists and objects that
+    // Clear keeps for reuse
+    struct MachineStats {
+        PoolStats Strings;
+        PoolStats Integers;
+        PoolStats Floats;
+        PoolStats Booleans;
+        PoolStats Lists;
+
+        // Includes the object shapes
+        PoolStats Objects;
+
+        // Source text kept by Machine::NewNumber
+        PoolStats RawNumbers;
+
+        PoolStats Total;
+
+        std::string ToString() const;
+    };
+
+    // Sizes of the pools of a Machine, taken just before another
+    // Machine was appended to it
+    struct Offsets {
+        key_t Strings = 0;
+        key_t Integers = 0;
+        key_t Floats = 0;
+        key_t Booleans = 0;
+        key_t Lists = 0;
+        key_t Objects = 0;
+
+        // Maps a Pointer into the appended Machine to a Pointer
+        // into the Machine it was appended to
+        Pointer Rebase(Pointer) const;
+    };
+
+    // Mixes the bits of a hash (the finalizer of SplitMix64)
+    uint64_t HashMix(uint64_t);
+
+    // By value, so that an integer and a float that are equal hash
+    // the same
+    uint64_t HashNumber(double);
+    uint64_t HashString(std::string_view);
+    uint64_t HashBoolean(bool);
+
+    // 64-bit hash of a value and everything under it, in any type of
+    // Machine. Equal values hash equal, across Machines too: a list
+    // hashes its elements in order, an object its entries in any
+    // order. Memo_Type gives a uint64_t & for each list and object,
+    // 0 until it is hashed.
+    template <typename Machine_Type, typename Memo_Type>
+    uint64_t HashValue(const Machine_Type &, Pointer, Memo_Type && memo);
+
+    // Adds each record of the list to the hash half, or to the
+    // ordered half, of an index of the field (see FieldIndex), in
+    // any type of Machine
+    template <typename Machine_Type>
+    void IndexHashes(FieldIndex &, const Machine_Type &, key_t list, const std::string & field);
+
+    template <typename Machine_Type>
+    void IndexNumbers(FieldIndex &, const Machine_Type &, key_t list, const std::string & field);
+
+    // Null, boolean, number, string, list, object
+    int TypeRank(Type);
+
+    // Positions of the keys of an object, in order of key, in any
+    // type of Machine
+    template <typename Object_Type>
+    std::vector<int> KeyOrder(const Object_Type &);
+
+    // Orders two values by kind (see TypeRank), then by value.
+    // Integers and floats compare as numbers, lists element by
+    // element, objects entry by entry in order of key. Returns less
+    // than, equal to or greater than 0.
+    template <typename Machine_Type>
+    int CompareValues(const Machine_Type &, Pointer, const Machine_Type &, Pointer);
+
+    class MappedMachine;
+    class MachineVersion;
+    struct Patch;
+
     class Machine {
         private:
             typedef
@@ -103,6 +811,8 @@ namespace Json {
             template <typename Machine_Pointer_Type = machine_ptr_t>
             class ResultSet {
                 friend class Machine;
+                friend class MappedMachine;
+                friend class MachineVersion;
 
                 private:
                     Machine_Pointer_Type
@@ -114,6 +824,15 @@ namespace Json {
                     std::string
                     RecurseToString(Pointer) const;
 
+                    // Of the records holding any of the hashes
+                    template <typename Match_Type>
+                    std::vector<ResultSet>
+                    WhereHash(
+                        const std::string & field,
+                        std::initializer_list<uint64_t> hashes,
+                        Match_Type && match
+                    ) const;
+
                     ResultSet(Machine_Pointer_Type, const Pointer &);
                 public:
                     ResultSet();
@@ -125,11 +844,51 @@ namespace Json {
                     bool AsString(std::string &) const;
                     ResultSet At(int) const;
                     ResultSet At(const std::string &) const;
+                    ResultSet At(key_cache_t &) const;
                     ResultSet operator[](int) const;
                     ResultSet operator[](const std::string &) const;
                     std::vector<ResultSet> Where(bool (*filter)(ResultSet)) const;
+
+                    // For a list of records, the ones whose field
+                    // equals the value, by type (see Equals), in list
+                    // order. Looked up in the HashIndex of the
+                    // Machine, which a Machine keeps and any other
+                    // Machine builds on each call.
+                    std::vector<ResultSet> WhereEquals(const std::string & field, int) const;
+                    std::vector<ResultSet> WhereEquals(const std::string & field, double) const;
+                    std::vector<ResultSet> WhereEquals(const std::string & field, bool) const;
+                    std::vector<ResultSet> WhereEquals(const std::string & field, const std::string &) const;
+                    std::vector<ResultSet> WhereEquals(const std::string & field, const char *) const;
+
+                    // For a list of records, the ones whose field is a
+                    // number from low to high, inclusive, in order of
+                    // the number. Looked up in the OrderedIndex of the
+                    // Machine, as WhereEquals is.
+                    std::vector<ResultSet> WhereBetween(const std::string & field, double low, double high) const;
+
+                    // For a list of records, one Column per field,
+                    // filled in one pass over the list
+                    std::vector<Column> Columns(const std::vector<std::string> & fields) const;
+
+                    // By kind, then by value (see CompareValues),
+                    // without serializing either side
                     int Compare(ResultSet) const;
+
+                    // Typed: a number equals a number of the same
+                    // value, integer or float. Values whose hashes
+                    // differ are unequal without a walk.
+                    bool Equals(ResultSet) const;
+                    bool Equals(int) const;
+                    bool Equals(double) const;
+                    bool Equals(bool) const;
+
+                    // A string of the same text; never a value of any
+                    // other type, as with WhereEquals
                     bool Equals(const std::string &) const;
+                    bool Equals(const char *) const;
+
+                    // Structural hash (see HashValue)
+                    uint64_t Hash() const;
                     Json::Type TypeCode() const;
                     bool IsNil() const;
                     std::string ToString() const;
@@ -142,12 +901,79 @@ namespace Json {
             std::vector<std::string>
             _strings;
 
-            std::vector<int>
+            // Interning mode.
+            //
+            // Every string key has a slot: an index into _interned,
+            // or -1 minus an index into _strings for a string of its
+            // own. Keys index _strings directly while _string_slots
+            // is empty, which it stays until interning is turned on.
+            std::vector<key_t>
+            _string_slots;
+
+            struct InternedString {
+                // Into _string_heap
+                size_t Offset;
+                size_t Length;
+                size_t Hash;
+            };
+
+            std::vector<InternedString>
+            _interned;
+
+            // Bytes of every interned string, back to back
+            std::string
+            _string_heap;
+
+            // Open addressing over _interned, -1 for an empty bucket.
+            // The size is a power of two.
+            std::vector<key_t>
+            _intern_table;
+
+            size_t
+            _interned_values = 0;
+
+            size_t
+            _interned_value_bytes = 0;
+
+            bool
+            _interning = false;
+
+            key_t Intern(std::string_view);
+            void Rehash(size_t);
+            std::string_view InternedText(key_t) const;
+            Pointer AddString(std::string_view);
+
+            // Numbers added by NewNumber are converted from their
+            // source text on first read
+            mutable std::vector<int>
             _integers;
 
-            std::vector<float>
+            mutable std::vector<float>
             _floats;
 
+            struct RawNumber {
+                // Into _number_text
+                size_t Offset;
+                size_t Length;
+                bool Converted;
+            };
+
+            mutable std::vector<RawNumber>
+            _raw_numbers;
+
+            std::string
+            _number_text;
+
+            // Index into _raw_numbers by integer or float key, or -1.
+            // Shorter than the pool when the last numbers have no text.
+            std::vector<key_t>
+            _raw_integers;
+
+            std::vector<key_t>
+            _raw_floats;
+
+            void Convert(Type, key_t) const;
+
             vector_bitset<>
             _booleans;
 
@@ -157,14 +983,91 @@ namespace Json {
             std::vector<object_t>
             _objects;
 
+            // Every object made by NewObject starts from this shape
+            std::shared_ptr<object_t::shape_t>
+            _root_shape;
+
+            // Emptied by Clear, with their capacity, for the builders
+            // to take before making new ones
+            std::vector<std::string>
+            _spare_strings;
+
+            std::vector<list_t>
+            _spare_lists;
+
+            std::vector<object_t>
+            _spare_objects;
+
             key_t
             _start;
+
+            PoolSizes
+            _growths;
+
+            // Structural hash of each list and object by key, 0 until
+            // hashed. Emptied by every non-const accessor, as are the
+            // indexes.
+            mutable std::vector<uint64_t>
+            _list_hashes;
+
+            mutable std::vector<uint64_t>
+            _object_hashes;
+
+            mutable FieldIndexCache
+            _indexes;
+
+            void DropCaches();
+
+            // Copies the value from the other Machine, depth-first.
+            // The remap gives a key_t & for each Pointer of the other
+            // Machine: the key of its copy, or -1 until it is copied.
+            template <typename Remap_Type>
+            Pointer CopyFrom(const Machine &, Pointer, Remap_Type &&);
+
+            // Apply without the copy. Leaves the operations before a
+            // failed one applied.
+            bool ApplyInPlace(const Patch &);
+
+            template <typename Pool_Type>
+            static void
+            Track(const Pool_Type & pool, size_t & growths) {
+                if (pool.size() == pool.capacity())
+                    ++growths;
+            }
         public:
             virtual ~Machine() = default;
             Machine();
+            Machine(const Machine &) = default;
+            Machine(Machine &&) = default;
+            Machine & operator=(const Machine &) = default;
+            Machine & operator=(Machine &&) = default;
 
             void SetStartingObject(key_t);
 
+            // Makes room for that many more values in each pool
+            void Reserve(const PoolSizes &);
+
+            // Rebuilds every pool with only the values reachable from
+            // the starting object, in depth-first order, and releases
+            // excess capacity. Values reached more than once stay
+            // shared. The starting object becomes object 0.
+            //
+            // Invalidates every Pointer and ResultSet into the
+            // Machine. Returns the bytes reclaimed, as reserved bytes
+            // in Stats.
+            size_t Compact();
+
+            // Empties every pool, keeping its capacity, along with the
+            // capacity of each string, list and object, for the next
+            // document to reuse. Shapes and the interning mode are
+            // kept, unless the shapes have reached MAX_SHAPES, in which
+            // case the next document starts a new tree. Growth counts
+            // keep adding up.
+            //
+            // Invalidates every Pointer and ResultSet into the
+            // Machine.
+            void Clear();
+
             Pointer NewObject();
             Pointer NewList();
             Pointer NewString(const std::string &);
@@ -172,20 +1075,77 @@ namespace Json {
             Pointer NewFloat(float);
             Pointer NewBoolean(bool);
 
+            // Keeps the text of a number without converting it. The
+            // pointer is an INTEGER for integral text that fits an int
+            // and a FLOAT otherwise, including integral text out of
+            // range.
+            Pointer NewNumber(const std::string &);
+
             object_t & Object(key_t);
             list_t & List(key_t);
+            // Gives an interned string a copy of its own first
             std::string & String(key_t);
             int & Integer(key_t);
             float & Float(key_t);
             void SetBoolean(key_t, bool);
 
+            // Also drop the source text of the number
+            void SetInteger(key_t, int);
+            void SetFloat(key_t, float);
+
             const object_t & Object(key_t) const;
             const list_t & List(key_t) const;
-            const std::string & String(key_t) const;
+            std::string_view String(key_t) const;
             const int & Integer(key_t) const;
             const float & Float(key_t) const;
             bool Boolean(key_t) const;
 
+            // Source text of a number added by NewNumber, or empty
+            std::string_view SourceText(Pointer) const;
+
+            // Converts the text of every number added by NewNumber
+            // now, which reads of a const Machine would otherwise do
+            // on first use
+            void ConvertNumbers() const;
+
+            // Structural hash of the value (see HashValue). A list or
+            // object keeps its hash until the Machine is next changed
+            // through a non-const accessor. Fills a cache, so readers
+            // on more than one thread must call ComputeHashes first.
+            uint64_t Hash(Pointer) const;
+            void ComputeHashes() const;
+
+            // Index of the field over the records of the list, by
+            // hash or by number (see JsonIndex.h). Built on first use,
+            // under a lock, and kept until the Machine is next changed
+            // through a non-const accessor, such as by
+            // ResultSet::Change*. Building one hashes the values, so
+            // readers on more than one thread must call ComputeHashes
+            // first.
+            const FieldIndex & HashIndex(key_t list, const std::string & field) const;
+            const FieldIndex & OrderedIndex(key_t list, const std::string & field) const;
+
+            // While on, NewString returns a key that shares its bytes
+            // with every equal string added in the same mode
+            void SetInterning(bool);
+            bool Interning() const;
+
+            key_t StringCount() const;
+            key_t IntegerCount() const;
+            key_t FloatCount() const;
+            key_t BooleanCount() const;
+            key_t ListCount() const;
+            key_t ObjectCount() const;
+
+            // Counts and bytes for every pool, in one pass over the
+            // strings, lists, objects and shapes
+            MachineStats Stats() const;
+
+            // Bytes that storing each interned string separately
+            // would have taken, less the bytes of the pool, its table
+            // and the slots. Approximate; ignores allocator overhead.
+            size_t InternedBytesSaved() const;
+
             std::string
             ToString() const;
 
@@ -200,6 +1160,48 @@ namespace Json {
 
             ResultSet<Machine *>
             GetResultSet(key_t start);
+
+            // At any value, not only an object
+            const ResultSet<const Machine *>
+            GetResultSet(Pointer) const;
+
+            ResultSet<Machine *>
+            GetResultSet(Pointer);
+
+            // Copies every pool of the other Machine to the end of
+            // the matching pool of this one, rebasing the pointers
+            // held by its lists and objects
+            Offsets Append(const Machine &);
+
+            // Copies a value of the other Machine, and everything
+            // under it, to the end of the pools of this one. Values
+            // reached more than once stay shared.
+            Pointer Copy(const Machine &, Pointer);
+
+            // Appends the other Machine and returns its starting
+            // object, rebased, for the caller to attach under a list
+            // or a key. Null if the other Machine has no objects.
+            Pointer Merge(const Machine &);
+
+            // Writes every pool to a file that MappedMachine can map
+            // (see JsonSnapshot.h). Returns false if the file could
+            // not be written.
+            bool SaveSnapshot(const std::string & path) const;
+
+            // Operations that turn this Machine into the other one
+            // (see JsonPatch.h). Lists and objects whose 64-bit hashes
+            // match are taken as equal without a walk, so an unequal
+            // pair that collides would lose its changes. With
+            // confirm, equal hashes are checked by a full comparison,
+            // which walks every unchanged subtree.
+            Patch Diff(const Machine &, bool confirm = false) const;
+
+            // Applies all of the operations in order, or none of them.
+            // Works on a copy, which replaces this Machine once every
+            // path has resolved, so it costs a copy of the document.
+            // Returns false, leaving the Machine as it was, at the
+            // first operation whose path does not resolve.
+            bool Apply(const Patch &);
     };
 };
 
@@ -222,7 +1224,7 @@ Json::Machine::ResultSet<T>::ResultSet():
         if (_pointer.type != TYPE_SYMBOL) \
             return false; \
         /* TODO: sfinae **see above */ \
-        value = _machine->NAME(_pointer.key); \
+        value = std::as_const(*_machine).NAME(_pointer.key); \
         return true; \
     }
 
@@ -238,7 +1240,7 @@ Json::Machine::ResultSet<T>::At(int index) const {
         return ResultSet(_machine, Pointer{ Type::NIL, 0 });
 
     /* TODO: sfinae **see above */
-    return ResultSet(_machine, _machine->List(_pointer.key).at(index));
+    return ResultSet(_machine, std::as_const(*_machine).List(_pointer.key).at(index));
 }
 
 template <typename T>
@@ -248,7 +1250,17 @@ Json::Machine::ResultSet<T>::At(const std::string & key) const {
         return ResultSet(_machine, Pointer{ Type::NIL, 0 });
 
     /* TODO: sfinae **see above */
-    return ResultSet(_machine, _machine->Object(_pointer.key).at(key));
+    return ResultSet(_machine, std::as_const(*_machine).Object(_pointer.key).at(key));
+}
+
+template <typename T>
+typename Json::Machine::ResultSet<T>
+Json::Machine::ResultSet<T>::At(key_cache_t & key) const {
+    if (_pointer.type != Type::OBJECT)
+        return ResultSet(_machine, Pointer{ Type::NIL, 0 });
+
+    /* TODO: sfinae **see above */
+    return ResultSet(_machine, key.at(std::as_const(*_machine).Object(_pointer.key)));
 }
 
 template <typename T>
@@ -280,7 +1292,7 @@ Json::Machine::ResultSet<T>::Where(bool (*filter)(ResultSet)) const {
     }
 
     /* TODO: sfinae **see above */
-    auto list = _machine->List(_pointer.key);
+    const auto & list = std::as_const(*_machine).List(_pointer.key);
 
     for (Pointer pointer : list) {
         ResultSet temp(_machine, pointer);
@@ -292,16 +1304,246 @@ Json::Machine::ResultSet<T>::Where(bool (*filter)(ResultSet)) const {
     return std::move(results);
 }
 
+template <typename T>
+template <typename M>
+std::vector<Json::Machine::ResultSet<T>>
+Json::Machine::ResultSet<T>::WhereHash(
+    const std::string & field,
+    std::initializer_list<uint64_t> hashes,
+    M && match
+) const {
+    std::vector<ResultSet> results;
+
+    if (_pointer.type != Type::LIST)
+        return results;
+
+    const auto & machine = std::as_const(*_machine);
+    const auto & list = machine.List(_pointer.key);
+
+    // A reference to the Machine's own index, or an index built for
+    // this call
+    const auto & index = machine.HashIndex(_pointer.key, field);
+    std::vector<size_t> positions;
+
+    for (uint64_t hash : hashes) {
+        auto & found = index.Find(hash);
+        positions.insert(positions.end(), found.begin(), found.end());
+    }
+
+    // In list order, once each
+    if (hashes.size() > 1) {
+        std::sort(positions.begin(), positions.end());
+        positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    }
+
+    // The hash can collide, so each candidate is checked
+    for (size_t position : positions) {
+        ResultSet record(_machine, list[position]);
+
+        if (match(record.At(field)))
+            results.push_back(record);
+    }
+
+    return results;
+}
+
+template <typename T>
+std::vector<Json::Machine::ResultSet<T>>
+Json::Machine::ResultSet<T>::WhereEquals(const std::string & field, int value) const {
+    return WhereHash(field, { HashNumber(value) }, [&](const ResultSet & found) {
+        return found.Equals(value);
+    });
+}
+
+template <typename T>
+std::vector<Json::Machine::ResultSet<T>>
+Json::Machine::ResultSet<T>::WhereEquals(const std::string & field, double value) const {
+    // A float is stored, and hashed, at float precision, but an
+    // integer at its own, such as 16777217, which no float holds
+    uint64_t rounded = HashNumber((float)value);
+    uint64_t exact = HashNumber(value);
+
+    auto match = [&](const ResultSet & found) {
+        return found.Equals(value);
+    };
+
+    return rounded == exact
+        ? WhereHash(field, { exact }, match)
+        : WhereHash(field, { rounded, exact }, match);
+}
+
+template <typename T>
+std::vector<Json::Machine::ResultSet<T>>
+Json::Machine::ResultSet<T>::WhereEquals(const std::string & field, bool value) const {
+    return WhereHash(field, { HashBoolean(value) }, [&](const ResultSet & found) {
+        return found.Equals(value);
+    });
+}
+
+template <typename T>
+std::vector<Json::Machine::ResultSet<T>>
+Json::Machine::ResultSet<T>::WhereEquals(const std::string & field, const std::string & value) const {
+    return WhereHash(field, { HashString(value) }, [&](const ResultSet & found) {
+        return found.Equals(value);
+    });
+}
+
+template <typename T>
+std::vector<Json::Machine::ResultSet<T>>
+Json::Machine::ResultSet<T>::WhereEquals(const std::string & field, const char * value) const {
+    return WhereEquals(field, std::string(value));
+}
+
+template <typename T>
+std::vector<Json::Machine::ResultSet<T>>
+Json::Machine::ResultSet<T>::WhereBetween(
+    const std::string & field,
+    double low,
+    double high
+) const {
+    std::vector<ResultSet> results;
+
+    if (_pointer.type != Type::LIST)
+        return results;
+
+    const auto & machine = std::as_const(*_machine);
+    const auto & list = machine.List(_pointer.key);
+    const auto & index = machine.OrderedIndex(_pointer.key, field);
+
+    for (size_t position : index.Between(low, high))
+        results.push_back(ResultSet(_machine, list[position]));
+
+    return results;
+}
+
+template <typename T>
+std::vector<Json::Column>
+Json::Machine::ResultSet<T>::Columns(const std::vector<std::string> & fields) const {
+    size_t size = 0;
+
+    if (_pointer.type == Type::LIST)
+        /* TODO: sfinae **see above */
+        size = std::as_const(*_machine).List(_pointer.key).size();
+
+    std::vector<Column> columns;
+    std::vector<key_cache_t> keys;
+    columns.reserve(fields.size());
+    keys.reserve(fields.size());
+
+    for (auto & field : fields) {
+        columns.emplace_back(field, size);
+        keys.emplace_back(field);
+    }
+
+    if (!size)
+        return columns;
+
+    /* TODO: sfinae **see above */
+    const auto & list = std::as_const(*_machine).List(_pointer.key);
+
+    for (size_t row = 0; row < size; ++row) {
+        Pointer record = list[row];
+
+        if (record.type != Type::OBJECT)
+            continue;
+
+        const auto & object = std::as_const(*_machine).Object(record.key);
+
+        for (size_t field = 0; field < fields.size(); ++field) {
+            Pointer value = keys[field].at(object);
+
+            switch (value.type) {
+                case Type::INTEGER:
+                    columns[field].Set(row, std::as_const(*_machine).Integer(value.key));
+                    break;
+                case Type::FLOAT:
+                    columns[field].Set(row, std::as_const(*_machine).Float(value.key));
+                    break;
+                case Type::BOOLEAN:
+                    columns[field].Set(row, std::as_const(*_machine).Boolean(value.key));
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    return columns;
+}
+
 template <typename T>
 int
 Json::Machine::ResultSet<T>::Compare(ResultSet other) const {
-    return ToString().compare(other.ToString());
+    return CompareValues(
+        std::as_const(*_machine), _pointer,
+        std::as_const(*other._machine), other._pointer
+    );
+}
+
+template <typename T>
+bool
+Json::Machine::ResultSet<T>::Equals(ResultSet other) const {
+    if (_pointer.type == other._pointer.type
+        && (_pointer.type == Type::LIST || _pointer.type == Type::OBJECT)
+        && Hash() != other.Hash()
+    )
+        return false;
+
+    return !Compare(other);
+}
+
+template <typename T>
+bool
+Json::Machine::ResultSet<T>::Equals(int value) const {
+    switch (_pointer.type) {
+        case Type::INTEGER:
+            return std::as_const(*_machine).Integer(_pointer.key) == value;
+        case Type::FLOAT:
+            return std::as_const(*_machine).Float(_pointer.key) == (double)value;
+        default:
+            return false;
+    }
 }
 
 template <typename T>
 bool
-Json::Machine::ResultSet<T>::Equals(const std::string & toString) const {
-    return !ToString().compare(toString);
+Json::Machine::ResultSet<T>::Equals(double value) const {
+    switch (_pointer.type) {
+        case Type::INTEGER:
+            return std::as_const(*_machine).Integer(_pointer.key) == value;
+        case Type::FLOAT:
+            // At the precision of the value stored
+            return std::as_const(*_machine).Float(_pointer.key) == (float)value;
+        default:
+            return false;
+    }
+}
+
+template <typename T>
+bool
+Json::Machine::ResultSet<T>::Equals(bool value) const {
+    return _pointer.type == Type::BOOLEAN
+        && std::as_const(*_machine).Boolean(_pointer.key) == value;
+}
+
+template <typename T>
+bool
+Json::Machine::ResultSet<T>::Equals(const std::string & value) const {
+    return _pointer.type == Type::STRING
+        && std::as_const(*_machine).String(_pointer.key) == value;
+}
+
+template <typename T>
+bool
+Json::Machine::ResultSet<T>::Equals(const char * value) const {
+    return _pointer.type == Type::STRING
+        && std::as_const(*_machine).String(_pointer.key) == value;
+}
+
+template <typename T>
+uint64_t
+Json::Machine::ResultSet<T>::Hash() const {
+    return std::as_const(*_machine).Hash(_pointer);
 }
 
 template <typename T>
@@ -316,7 +1558,7 @@ Json::Machine::ResultSet<T>::RecurseToString(
             outss
                 << '"'
                 /* TODO: sfinae **see above */
-                << _machine->String(value.key)
+                << std::as_const(*_machine).String(value.key)
                 << '"';
 
             break;
@@ -350,14 +1592,20 @@ Json::Machine::ResultSet<T>::ToString() const {
     switch (_pointer.type) {
         case Json::Type::STRING:
             /* TODO: sfinae **see above */
-            return _machine->String(_pointer.key);
+            return std::string(std::as_const(*_machine).String(_pointer.key));
         case Json::Type::INTEGER:
+            if (auto text = _machine->SourceText(_pointer); !text.empty())
+                return std::string(text);
+
             /* TODO: sfinae **see above */
-            outss << _machine->Integer(_pointer.key);
+            outss << std::as_const(*_machine).Integer(_pointer.key);
             break;
         case Json::Type::FLOAT:
+            if (auto text = _machine->SourceText(_pointer); !text.empty())
+                return std::string(text);
+
             /* TODO: sfinae **see above */
-            outss << _machine->Float(_pointer.key);
+            outss << std::as_const(*_machine).Float(_pointer.key);
             break;
         case Json::Type::BOOLEAN:
             outss << (
@@ -370,19 +1618,18 @@ Json::Machine::ResultSet<T>::ToString() const {
             {
                 outss << "{ ";
                 /* TODO: sfinae **see above */
-                auto object = _machine->Object(_pointer.key);
-                std::string key;
-
-                for (int i = 0; i < object.keys().size(); ++i) {
-                    key = object.keys()[i];
+                const auto & object = std::as_const(*_machine).Object(_pointer.key);
+                const auto & keys = object.keys();
+                const auto & values = object.values();
 
+                for (size_t i = 0; i < keys.size(); ++i) {
                     outss
                         << '"'
-                        << key
+                        << keys[i]
                         << "\": "
-                        << RecurseToString(object.at(key));
+                        << RecurseToString(values[i]);
 
-                    if (i < object.keys().size() - 1)
+                    if (i < keys.size() - 1)
                         outss << ", ";
                 }
 
@@ -394,7 +1641,7 @@ Json::Machine::ResultSet<T>::ToString() const {
             {
                 outss << "[ ";
                 /* TODO: sfinae **see above */
-                auto list = _machine->List(_pointer.key);
+                const auto & list = std::as_const(*_machine).List(_pointer.key);
 
                 for (int i = 0; i < list.size(); ++i) {
                     outss << RecurseToString(list.at(i));
@@ -420,6 +1667,7 @@ bool Json::Machine::ResultSet<T>::ChangeString(const std::string & value) {
         return false;
 
     /* TODO: sfinae **see above */
+    // Copies on write when the string is interned
     _machine->String(_pointer.key) = value;
     return true;
 }
@@ -429,7 +1677,7 @@ bool Json::Machine::ResultSet<T>::ChangeInteger(int value) {
     switch (TypeCode()) {
         case Type::INTEGER:
             /* TODO: sfinae **see above */
-            _machine->Integer(_pointer.key) = value;
+            _machine->SetInteger(_pointer.key, value);
             return true;
         case Type::BOOLEAN:
             /* TODO: sfinae **see above */
@@ -448,8 +1696,198 @@ bool Json::Machine::ResultSet<T>::ChangeFloat(float value) {
         return false;
 
     /* TODO: sfinae **see above */
-    _machine->Float(_pointer.key) = value;
+    _machine->SetFloat(_pointer.key, value);
     return true;
 }
 
+template <typename M, typename S>
+uint64_t
+Json::HashValue(const M & machine, Pointer value, S && memo) {
+    // Seeds keep values of different kinds apart
+    switch (value.type) {
+        case Type::STRING:
+            return HashString(machine.String(value.key));
+        case Type::INTEGER:
+            return HashNumber(machine.Integer(value.key));
+        case Type::FLOAT:
+            return HashNumber(machine.Float(value.key));
+        case Type::BOOLEAN:
+            return HashBoolean(machine.Boolean(value.key));
+        case Type::LIST:
+            {
+                uint64_t & hash = memo(value);
+
+                if (hash)
+                    return hash;
+
+                const auto & list = machine.List(value.key);
+                uint64_t result = HashMix(0xFF51AFD7ED558CCDULL ^ list.size());
+
+                for (Pointer element : list)
+                    result = HashMix(result + HashValue(machine, element, memo));
+
+                return hash = result ? result : 1;
+            }
+        case Type::OBJECT:
+            {
+                uint64_t & hash = memo(value);
+
+                if (hash)
+                    return hash;
+
+                const auto & object = machine.Object(value.key);
+                uint64_t result = 0;
+
+                // A sum, so that the order of the keys does not count
+                for (size_t i = 0; i < object.size(); ++i)
+                    result += HashMix(
+                        std::hash<std::string_view>()(object.keys()[i])
+                        ^ HashMix(
+                            HashValue(machine, object.values()[i], memo)
+                            + 0xC4CEB9FE1A85EC53ULL
+                        )
+                    );
+
+                result = HashMix(result ^ 0xC4CEB9FE1A85EC53ULL ^ object.size());
+                return hash = result ? result : 1;
+            }
+        default:
+            return 0x27D4EB2F165667C5ULL;
+    }
+}
+
+template <typename M>
+void
+Json::IndexHashes(FieldIndex & index, const M & machine, key_t list, const std::string & field) {
+    key_cache_t key(field);
+    const auto & records = machine.List(list);
+
+    for (size_t i = 0; i < records.size(); ++i) {
+        Pointer record = records[i];
+
+        if (record.type != Type::OBJECT)
+            continue;
+
+        Pointer value = key.at(machine.Object(record.key));
+
+        if (value.type != Type::NIL)
+            index.AddHash(machine.Hash(value), i);
+    }
+
+    index.FinishHashes();
+}
+
+template <typename M>
+void
+Json::IndexNumbers(FieldIndex & index, const M & machine, key_t list, const std::string & field) {
+    key_cache_t key(field);
+    const auto & records = machine.List(list);
+
+    for (size_t i = 0; i < records.size(); ++i) {
+        Pointer record = records[i];
+
+        if (record.type != Type::OBJECT)
+            continue;
+
+        Pointer value = key.at(machine.Object(record.key));
+
+        if (value.type == Type::INTEGER)
+            index.AddNumber(machine.Integer(value.key), i);
+        else if (value.type == Type::FLOAT)
+            index.AddNumber(machine.Float(value.key), i);
+    }
+
+    index.FinishOrder();
+}
+
+template <typename O>
+std::vector<int>
+Json::KeyOrder(const O & object) {
+    std::vector<int> positions(object.size());
+    std::iota(positions.begin(), positions.end(), 0);
+    const auto & keys = object.keys();
+
+    std::sort(positions.begin(), positions.end(), [&](int a, int b) {
+        return keys[a] < keys[b];
+    });
+
+    return positions;
+}
+
+template <typename M>
+int
+Json::CompareValues(const M & machine, Pointer value, const M & other, Pointer otherValue) {
+    int rank = TypeRank(value.type) - TypeRank(otherValue.type);
+
+    if (rank)
+        return rank < 0 ? -1 : 1;
+
+    switch (value.type) {
+        case Type::STRING:
+            {
+                int order = machine.String(value.key).compare(other.String(otherValue.key));
+                return (order > 0) - (order < 0);
+            }
+        case Type::INTEGER:
+        case Type::FLOAT:
+            {
+                double number = value.type == Type::INTEGER
+                    ? (double)machine.Integer(value.key)
+                    : (double)machine.Float(value.key);
+
+                double otherNumber = otherValue.type == Type::INTEGER
+                    ? (double)other.Integer(otherValue.key)
+                    : (double)other.Float(otherValue.key);
+
+                return (number > otherNumber) - (number < otherNumber);
+            }
+        case Type::BOOLEAN:
+            return (int)machine.Boolean(value.key) - (int)other.Boolean(otherValue.key);
+        case Type::LIST:
+            {
+                const auto & list = machine.List(value.key);
+                const auto & otherList = other.List(otherValue.key);
+                size_t size = std::min(list.size(), otherList.size());
+
+                for (size_t i = 0; i < size; ++i)
+                    if (int order = CompareValues(machine, list[i], other, otherList[i]))
+                        return order;
+
+                return (list.size() > otherList.size()) - (list.size() < otherList.size());
+            }
+        case Type::OBJECT:
+            {
+                const auto & object = machine.Object(value.key);
+                const auto & otherObject = other.Object(otherValue.key);
+                auto positions = KeyOrder(object);
+                auto otherPositions = KeyOrder(otherObject);
+                size_t size = std::min(positions.size(), otherPositions.size());
+
+                for (size_t i = 0; i < size; ++i) {
+                    int position = positions[i];
+                    int otherPosition = otherPositions[i];
+
+                    int order = object.keys()[position]
+                        .compare(otherObject.keys()[otherPosition]);
+
+                    if (order)
+                        return (order > 0) - (order < 0);
+
+                    order = CompareValues(
+                        machine, object.values()[position],
+                        other, otherObject.values()[otherPosition]
+                    );
+
+                    if (order)
+                        return order;
+                }
+
+                return (positions.size() > otherPositions.size())
+                    - (positions.size() < otherPositions.size());
+            }
+        default:
+            return 0;
+    }
+}
+
 #endif
@@ -0,0 +1,267 @@
+#pragma once
+#ifndef _JSONPARALLEL_H
+#define _JSONPARALLEL_H
+
+#include "JsonTraversal.h"
+#include <algorithm>
+#include <future>
+#include <thread>
+
+namespace Json {
+    // Subtrees with fewer nodes are visited sequentially
+    const size_t PARALLEL_THRESHOLD = 4096;
+
+    // Stands for the number of cores
+    const size_t PARALLEL_THREADS = 0;
+
+    // Number of nodes in the subtree at each node of a tree, in
+    // preorder, counting null subtrees. The children of the node at
+    // position p start at p + 1, each one past the subtree of the
+    // one before.
+    template <typename T>
+    std::vector<size_t> Sizes(const Tree<T> * tree);
+
+    // Postorder traversal that visits large sibling subtrees on
+    // separate threads.
+    //
+    // The children of a container of at least threshold nodes are
+    // cut into consecutive batches of at least threshold nodes, no
+    // more batches than threads. Each batch is visited by its own
+    // copy of the visitor, forked from the parent's, which writes
+    // into an output of its own. Once all batches are done, the
+    // parent joins their outputs in order and visits the container.
+    //
+    // The threads are shared out among the batches, so that the
+    // whole traversal never runs more than that many at once.
+    //
+    // Besides the IPostorderVisitor member functions, Visitor_Type
+    // needs
+    //
+    //   Visitor_Type Fork() const;
+    //   void Join(Visitor_Type & forked, ValueRange<T> values);
+    //
+    // where Join moves the output of the forked visitor into this
+    // one and rebases the values the forked visitor returned.
+    template <typename T, typename Visitor_Type>
+    T ParallelPostorder(
+        const Tree<T> * tree,
+        Visitor_Type & visitor,
+        size_t threshold = PARALLEL_THRESHOLD,
+        size_t threads = PARALLEL_THREADS
+    );
+
+    // Visits the subtree at the given position of sizes, which were
+    // counted once for the whole tree
+    template <typename T, typename Visitor_Type>
+    T ParallelPostorder(
+        const Tree<T> * tree,
+        const std::vector<size_t> & sizes,
+        size_t position,
+        Visitor_Type & visitor,
+        size_t threshold,
+        size_t threads
+    );
+};
+
+template <typename T>
+std::vector<size_t>
+Json::Sizes(const Tree<T> * tree) {
+    struct Frame {
+        const Tree<T> * Node;
+        size_t Next;
+        size_t Position;
+    };
+
+    std::vector<size_t> sizes;
+    std::vector<Frame> frames;
+
+    // Counts a node, and pushes a container to be finished once its
+    // children are counted
+    auto start = [&](const Tree<T> * node) {
+        sizes.push_back(1);
+
+        if (node
+            && node->GetKind() != Tree<T>::Kind::STRING
+            && node->GetKind() != Tree<T>::Kind::NUMERIC
+        )
+            frames.push_back(Frame { node, 0, sizes.size() - 1 });
+    };
+
+    start(tree);
+
+    while (!frames.empty()) {
+        Frame & frame = frames.back();
+
+        auto & children = frame.Node->GetKind() == Tree<T>::Kind::OBJECT
+            ? static_cast<const Object<T> *>(frame.Node)->Values()
+            : static_cast<const List<T> *>(frame.Node)->Values();
+
+        if (frame.Next < children.size()) {
+            // Invalidates frame
+            start(children[frame.Next++].get());
+            continue;
+        }
+
+        sizes[frame.Position] = sizes.size() - frame.Position;
+        frames.pop_back();
+    }
+
+    return sizes;
+}
+
+template <typename T, typename V>
+T
+Json::ParallelPostorder(
+    const Tree<T> * tree,
+    V & visitor,
+    size_t threshold,
+    size_t threads
+) {
+    if (threads == PARALLEL_THREADS)
+        threads = std::max(1U, std::thread::hardware_concurrency());
+
+    return ParallelPostorder(tree, Sizes(tree), 0, visitor, threshold, threads);
+}
+
+template <typename T, typename V>
+T
+Json::ParallelPostorder(
+    const Tree<T> * tree,
+    const std::vector<size_t> & sizes,
+    size_t position,
+    V & visitor,
+    size_t threshold,
+    size_t threads
+) {
+    size_t count = sizes[position];
+
+    if (!tree
+        || threads < 2
+        || count < threshold
+        || tree->GetKind() == Tree<T>::Kind::STRING
+        || tree->GetKind() == Tree<T>::Kind::NUMERIC
+    )
+        return Traversal<T>().Postorder(tree, visitor);
+
+    bool isObject = tree->GetKind() == Tree<T>::Kind::OBJECT;
+
+    auto & children = isObject
+        ? static_cast<const Object<T> *>(tree)->Values()
+        : static_cast<const List<T> *>(tree)->Values();
+
+    // Position of each child in sizes
+    std::vector<size_t> positions;
+    positions.reserve(children.size());
+
+    for (size_t i = 0, next = position + 1; i < children.size(); ++i) {
+        positions.push_back(next);
+        next = next + sizes[next];
+    }
+
+    // Every batch but the last holds at least batchSize nodes, so
+    // there are no more batches than threads
+    size_t batchSize = std::max(
+        threshold,
+        (count + threads - 1) / threads
+    );
+
+    struct Batch {
+        size_t Begin;
+        size_t End;
+        V Visitor;
+        std::vector<T> Values;
+    };
+
+    std::vector<size_t> ends;
+    size_t sum = 0;
+
+    for (size_t i = 0; i < children.size(); ++i) {
+        sum = sum + sizes[positions[i]];
+
+        if (sum >= batchSize || i == children.size() - 1) {
+            ends.push_back(i + 1);
+            sum = 0;
+        }
+    }
+
+    // Of the threads, each batch takes its share
+    size_t share = threads / ends.size();
+
+    auto visitBatch = [&](Batch & batch) {
+        batch.Values.reserve(batch.End - batch.Begin);
+
+        for (size_t i = batch.Begin; i < batch.End; ++i)
+            batch.Values.push_back(ParallelPostorder(
+                children[i].get(),
+                sizes,
+                positions[i],
+                batch.Visitor,
+                threshold,
+                share
+            ));
+    };
+
+    std::vector<T> values;
+    values.reserve(children.size());
+
+    if (ends.size() == 1) {
+        // Nothing to run beside it
+        for (size_t i = 0; i < children.size(); ++i)
+            values.push_back(ParallelPostorder(
+                children[i].get(),
+                sizes,
+                positions[i],
+                visitor,
+                threshold,
+                threads
+            ));
+    }
+    else {
+        std::vector<Batch> batches;
+        batches.reserve(ends.size());
+
+        for (size_t i = 0; i < ends.size(); ++i)
+            batches.push_back(Batch {
+                i ? ends[i - 1] : 0,
+                ends[i],
+                visitor.Fork(),
+                std::vector<T>()
+            });
+
+        std::vector<std::future<void>> tasks;
+
+        // The calling thread takes the last batch
+        for (size_t i = 0; i < batches.size() - 1; ++i)
+            tasks.push_back(std::async(
+                std::launch::async,
+                visitBatch,
+                std::ref(batches[i])
+            ));
+
+        visitBatch(batches.back());
+
+        for (auto & task : tasks)
+            task.get();
+
+        for (auto & batch : batches) {
+            visitor.Join(
+                batch.Visitor,
+                ValueRange<T>(batch.Values.data(), batch.Values.size())
+            );
+
+            for (auto & value : batch.Values)
+                values.push_back(std::move(value));
+        }
+    }
+
+    ValueRange<T> range(values.data(), values.size());
+
+    return isObject
+        ? visitor.ForObject(
+            static_cast<const Object<T> *>(tree)->Keys(),
+            range
+        )
+        : visitor.ForList(range);
+}
+
+#endif
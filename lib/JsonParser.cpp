@@ -1,5 +1,37 @@
 #include "JsonParser.h"
 
+std::string
+Json::ToString(Json::ErrorCode code) {
+    switch (code) {
+        case Json::ErrorCode::NONE:
+            return "";
+        case Json::ErrorCode::EXPECTED_OPENING_BRACE:
+            return "Expected '{'";
+        case Json::ErrorCode::EXPECTED_CLOSING_BRACE:
+            return "Expected '}'";
+        case Json::ErrorCode::EXPECTED_CLOSING_BRACKET:
+            return "Expected ']'";
+        case Json::ErrorCode::EXPECTED_STRING:
+            return "Expected a string";
+        case Json::ErrorCode::EXPECTED_COLON:
+            return "Expected ':'";
+        case Json::ErrorCode::EXPECTED_NUMBER:
+            return "Expected a number (integer, float, or boolean)";
+        case Json::ErrorCode::UNEXPECTED_KEYWORD:
+            return "Unexpected keyword";
+        case Json::ErrorCode::DEPTH_LIMIT_EXCEEDED:
+            return "Exceeded the maximum depth";
+        case Json::ErrorCode::STRING_LIMIT_EXCEEDED:
+            return "Exceeded the maximum string length";
+        case Json::ErrorCode::NODE_LIMIT_EXCEEDED:
+            return "Exceeded the maximum number of values";
+        case Json::ErrorCode::MEMORY_LIMIT_EXCEEDED:
+            return "Exceeded the memory budget";
+    }
+
+    return "";
+}
+
 int Json::Parsing::Escape(::Lexer & lexer) {
     if (!lexer.NextChar())
         return Token::ERROR;
@@ -83,3 +115,23 @@ int
 Json::Lexer::Index() const {
     return _lexer.Index();
 }
+
+void
+Json::Lexer::SetMaxStringLength(int maxLength) {
+    _lexer.SetMaxLength(maxLength);
+}
+
+bool
+Json::Lexer::StringLimitExceeded() const {
+    return _lexer.LengthExceeded();
+}
+
+void
+Json::Lexer::SetRawNumbers(bool rawNumbers) {
+    _lexer.SetRawNumbers(rawNumbers);
+}
+
+void
+Json::Lexer::Restart() {
+    _lexer.Restart();
+}
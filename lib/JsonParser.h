@@ -3,6 +3,8 @@
 #define _JSONPARSER_H
 
 #include "Homonumeric.h"
+#include "JsonArena.h"
+#include "JsonProjection.h"
 #include "Lexer.h"
 #include <vector>
 
@@ -11,21 +13,25 @@
 //   retrieved: 2022_07_26
 
 namespace Json {
+    // Keys and child arrays come as std::pmr types allocated from
+    // Resource(), and nodes are returned through a TreeDeleter.
+    // Factories written against std::vector, std::string keys and
+    // std::unique_ptr need their signatures changed to match.
     template <typename Tree_Type>
     class ITreeFactory {
         public:
-            typedef std::unique_ptr<Tree_Type>
+            typedef std::unique_ptr<Tree_Type, TreeDeleter<Tree_Type>>
             ptr_t;
 
             virtual ~ITreeFactory() = default;
 
             virtual ptr_t NewObject(
-                std::vector<std::string> keys,
-                std::vector<ptr_t> values
+                tree_keys_t keys,
+                std::pmr::vector<ptr_t> values
             ) = 0;
 
             virtual ptr_t NewList(
-                std::vector<ptr_t> values
+                std::pmr::vector<ptr_t> values
             ) = 0;
 
             virtual ptr_t NewString(
@@ -35,6 +41,64 @@ namespace Json {
             virtual ptr_t NewNumeric(
                 Homonumeric
             ) = 0;
+
+            // The parser allocates the key and value arrays it hands
+            // to NewObject and NewList from this resource
+            virtual std::pmr::memory_resource * Resource() {
+                return std::pmr::get_default_resource();
+            }
+    };
+
+    enum class ErrorCode {
+        NONE,
+        EXPECTED_OPENING_BRACE,
+        EXPECTED_CLOSING_BRACE,
+        EXPECTED_CLOSING_BRACKET,
+        EXPECTED_STRING,
+        EXPECTED_COLON,
+        EXPECTED_NUMBER,
+        UNEXPECTED_KEYWORD,
+        DEPTH_LIMIT_EXCEEDED,
+        STRING_LIMIT_EXCEEDED,
+        NODE_LIMIT_EXCEEDED,
+        MEMORY_LIMIT_EXCEEDED
+    };
+
+    std::string
+    ToString(ErrorCode);
+
+    // Budgets a parser enforces while it reads, so that one
+    // pathological document fails early instead of stalling its
+    // worker. Zero leaves a limit unchecked.
+    struct Limits {
+        // Nesting of objects and lists, counting the starting object
+        int MaxDepth = 0;
+
+        // Length of any one string or key, checked by the lexer
+        // as the string is read
+        int MaxStringBytes = 0;
+
+        // Values of any kind, including containers
+        int MaxNodes = 0;
+
+        // Approximate Machine footprint of the values built: a fixed
+        // cost per value plus the bytes of every string and key
+        size_t MaxMachineBytes = 0;
+    };
+
+    // Receives the values of a document in order, without building
+    // anything. Parser::Scan accepts any class with these member
+    // functions.
+    class NullSink {
+        public:
+            void StartObject() {}
+            void Key(const std::string &) {}
+            void EndObject() {}
+            void StartList() {}
+            void EndList() {}
+            void String(const std::string &) {}
+            void Numeric(Homonumeric) {}
+            void Null() {}
     };
 
     class Parsing {
@@ -54,24 +118,51 @@ namespace Json {
             virtual int Integer() const;
             virtual float Float() const;
             virtual int Index() const;
+            virtual void SetMaxStringLength(int);
+
+            // See ::Lexer::LengthExceeded
+            virtual bool StringLimitExceeded() const;
+
+            // Numbers come as Token::NUMBER, with their source text
+            // in String()
+            virtual void SetRawNumbers(bool);
+
+            // See ::Lexer::Restart
+            virtual void Restart();
     };
 
-    template <typename Tree_Type>
+    // Factory_Type may be any class with the ITreeFactory member
+    // functions. A concrete (final) factory lets the compiler inline
+    // node construction; the default goes through the virtual
+    // interface.
+    template <
+        typename Tree_Type,
+        typename Factory_Type = ITreeFactory<Tree_Type>
+    >
     class Parser {
         public:
-            typedef typename std::unique_ptr<Tree_Type>
-            tree_t;
-
             typedef typename ITreeFactory<Tree_Type>::ptr_t
             ptr_t;
 
+            typedef ptr_t
+            tree_t;
+
             struct ResultSet {
                 bool Success;
                 ptr_t Tree;
                 std::string Message;
+
+                // The value was validated but not selected by the
+                // projection, and no subtree was built
+                bool Skipped = false;
+
+                ErrorCode Code = ErrorCode::NONE;
+
+                // Lexer index at which the error was found
+                int Offset = 0;
             };
         private:
-            std::unique_ptr<ITreeFactory<Tree_Type>>
+            std::unique_ptr<Factory_Type>
             _factory;
 
             std::shared_ptr<Lexer>
@@ -79,104 +170,272 @@ namespace Json {
 
             int
             _token;
+
+            const Projection *
+            _projection;
+
+            Limits
+            _limits;
+
+            int
+            _depth;
+
+            int
+            _nodes;
+
+            size_t
+            _bytes;
+
+            ErrorCode
+            _exceeded;
+
+            // While scanning a value the projection leaves out, which
+            // is not built and so not charged to the memory budget
+            bool
+            _skipping;
+
+            // Source text of the last raw number, with its sign
+            std::string
+            _number;
+
+            // Charged to the memory budget for every value built
+            static const size_t VALUE_BYTES = 16;
         protected:
-            ResultSet ParseObject();
-            ResultSet ParseList();
-            void ParsePair(std::string &, ResultSet &);
-            ResultSet ParseValue();
+            ResultSet ParseObject(const Projection *);
+            ResultSet ParseList(const Projection *);
+            void ParsePair(tree_string_t &, ResultSet &, const Projection *);
+            ResultSet ParseValue(const Projection *);
             ResultSet ParsePrimitive();
             ResultSet ParseNumber(bool);
             ResultSet ParseKeyword();
+            template <typename Sink_Type>
+            ResultSet ScanObject(Sink_Type &&);
+
+            template <typename Sink_Type>
+            ResultSet ScanList(Sink_Type &&);
+
+            template <typename Sink_Type>
+            ResultSet ScanValue(Sink_Type &&);
+
             int NextToken();
-            ResultSet Error(const std::string &);
+            bool Descend();
+            void Ascend();
+            bool Admit();
+            bool Charge(size_t);
+            ResultSet Error(ErrorCode, const std::string &);
+            ResultSet Exceeded();
             ResultSet Subtree(ptr_t &&);
+            ResultSet Skipped();
+            ResultSet Skip();
         public:
             virtual ~Parser() = default;
 
             Parser(
-                std::unique_ptr<ITreeFactory<Tree_Type>> factory,
+                std::unique_ptr<Factory_Type> factory,
                 std::shared_ptr<Lexer> lexer
             ):  _factory(std::move(factory)),
                 _lexer(lexer),
-                _token(0) {}
+                _token(0),
+                _projection(nullptr),
+                _depth(0),
+                _nodes(0),
+                _bytes(0),
+                _exceeded(ErrorCode::NONE),
+                _skipping(false) {}
 
             Parser(
-                std::unique_ptr<ITreeFactory<Tree_Type>> factory
+                std::unique_ptr<Factory_Type> factory
             ):  _factory(std::move(factory)),
                 _lexer(std::make_shared<Lexer>()),
-                _token(0) {}
+                _token(0),
+                _projection(nullptr),
+                _depth(0),
+                _nodes(0),
+                _bytes(0),
+                _exceeded(ErrorCode::NONE),
+                _skipping(false) {}
+
+            // Builds only the branches named in the projection.
+            // The projection must outlive the parse.
+            void Select(const Projection *);
+
+            void SetLimits(const Limits &);
+
+            // Clears the depth and the counts charged to the limits,
+            // for another document from the same lexer
+            void Reset();
 
             ResultSet GetTree();
 
+            // Runs the grammar of GetTree against a sink in place of
+            // the factory
+            template <typename Sink_Type>
+            ResultSet Scan(Sink_Type && sink);
+
+            static ResultSet Tree(
+                std::unique_ptr<Factory_Type> factory,
+                std::shared_ptr<Lexer> lexer
+            );
+
             static ResultSet Tree(
-                std::unique_ptr<ITreeFactory<Tree_Type>> factory,
                 std::shared_ptr<Lexer> lexer
             );
 
+            // Checks that the document is well-formed without
+            // building a tree
+            static ResultSet Validate(
+                std::shared_ptr<Lexer> lexer,
+                const Limits & limits = Limits()
+            );
+
             /* TODO: sfinae **see above */ \
-            template <typename Factory_Type>
+            template <typename Other_Factory_Type>
             static ResultSet Tree(
                 std::shared_ptr<Lexer> lexer
             );
 
             /* TODO: sfinae **see above */ \
-            template <template <class> class Factory_Type>
+            template <template <class> class Other_Factory_Type>
             static ResultSet Tree(
                 std::shared_ptr<Lexer> lexer
             );
     };
 };
 
-template <typename T>
+template <typename T, typename F>
 int
-Json::Parser<T>::NextToken() {
-    return _token = _lexer->NextToken();
+Json::Parser<T, F>::NextToken() {
+    _token = _lexer->NextToken();
+
+    if (_token == Token::ERROR && _lexer->StringLimitExceeded())
+        _exceeded = ErrorCode::STRING_LIMIT_EXCEEDED;
+
+    return _token;
+}
+
+template <typename T, typename F>
+bool
+Json::Parser<T, F>::Descend() {
+    _depth = _depth + 1;
+
+    if (_limits.MaxDepth && _depth > _limits.MaxDepth)
+        _exceeded = ErrorCode::DEPTH_LIMIT_EXCEEDED;
+
+    return _exceeded == ErrorCode::NONE;
+}
+
+template <typename T, typename F>
+void
+Json::Parser<T, F>::Ascend() {
+    _depth = _depth - 1;
+}
+
+template <typename T, typename F>
+bool
+Json::Parser<T, F>::Admit() {
+    _nodes = _nodes + 1;
+
+    if (_limits.MaxNodes && _nodes > _limits.MaxNodes)
+        _exceeded = ErrorCode::NODE_LIMIT_EXCEEDED;
+
+    return _exceeded == ErrorCode::NONE;
 }
 
-template <typename T>
-typename Json::Parser<T>::ResultSet
-Json::Parser<T>::GetTree() {
+template <typename T, typename F>
+bool
+Json::Parser<T, F>::Charge(size_t bytes) {
+    if (_skipping)
+        return _exceeded == ErrorCode::NONE;
+
+    _bytes = _bytes + bytes;
+
+    if (_limits.MaxMachineBytes && _bytes > _limits.MaxMachineBytes)
+        _exceeded = ErrorCode::MEMORY_LIMIT_EXCEEDED;
+
+    return _exceeded == ErrorCode::NONE;
+}
+
+template <typename T, typename F>
+void
+Json::Parser<T, F>::SetLimits(const Limits & limits) {
+    _limits = limits;
+    _lexer->SetMaxStringLength(limits.MaxStringBytes);
+}
+
+template <typename T, typename F>
+void
+Json::Parser<T, F>::Reset() {
+    _token = 0;
+    _depth = 0;
+    _nodes = 0;
+    _bytes = 0;
+    _exceeded = ErrorCode::NONE;
+    _skipping = false;
+}
+
+template <typename T, typename F>
+void
+Json::Parser<T, F>::Select(const Projection * projection) {
+    _projection = projection;
+}
+
+template <typename T, typename F>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::GetTree() {
     NextToken();
 
     if (_token != '{')
         // Error, gnostic
-        return Error("Expected '{'");
+        return Error(ErrorCode::EXPECTED_OPENING_BRACE, "Expected '{'");
+
+    if (!Admit())
+        // Error, gnostic
+        return Exceeded();
 
     // Subtree, agnostic
-    return ParseObject();
+    return ParseObject(_projection);
 }
 
-template <typename T>
-typename Json::Parser<T>::ResultSet
-Json::Parser<T>::ParseObject() {
+template <typename T, typename F>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::ParseObject(const Projection * projection) {
     // [x] TODO: Consider adding a kill condition at the
     //   start of each Parse function.
     //   
     //   2022_07_28: If the code reaches this section,
     //   then no error has occurred, and there's no need
     //   for a kill condition.
-    std::vector<std::string> keys;
-    std::vector<tree_t> values;
-    std::string key;
+    tree_keys_t keys(_factory->Resource());
+    std::pmr::vector<tree_t> values(_factory->Resource());
+    tree_string_t key(_factory->Resource());
     ResultSet value;
 
+    if (!Descend())
+        // Error, gnostic
+        return Exceeded();
+
     do {
         // Subtree, agnostic
-        ParsePair(key, value);
+        ParsePair(key, value, projection);
 
         if (!value.Success)
             // Error, agnostic
             return value;
 
-        keys.push_back(std::move(key));
-        values.push_back(std::move(value.Tree));
+        if (!value.Skipped) {
+            keys.push_back(std::move(key));
+            values.push_back(std::move(value.Tree));
+        }
+
         NextToken();
     }
     while (_token == ',');
 
     if (_token != '}')
         // Error, gnostic
-        return Error("Expected '}'");
+        return Error(ErrorCode::EXPECTED_CLOSING_BRACE, "Expected '}'");
+
+    Ascend();
 
     // Subtree, gnostic
     return Subtree(
@@ -189,27 +448,35 @@ Json::Parser<T>::ParseObject() {
     );
 }
 
-template <typename T>
-typename Json::Parser<T>::ResultSet
-Json::Parser<T>::ParseList() {
-    auto values = std::vector<tree_t>();
+template <typename T, typename F>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::ParseList(const Projection * projection) {
+    std::pmr::vector<tree_t> values(_factory->Resource());
+
+    if (!Descend())
+        // Error, gnostic
+        return Exceeded();
 
     do {
         // Subtree, agnostic
-        auto value = ParseValue();
+        auto value = ParseValue(projection);
 
-        if (_token == Token::ERROR)
+        if (!value.Success)
             // Error, agnostic
             return value;
 
-        values.push_back(std::move(value.Tree));
+        if (!value.Skipped)
+            values.push_back(std::move(value.Tree));
+
         NextToken();
     }
     while (_token == ',');
 
     if (_token != ']')
         // Error, gnostic
-        return Error("Expected ']'");
+        return Error(ErrorCode::EXPECTED_CLOSING_BRACKET, "Expected ']'");
+
+    Ascend();
 
     // Subtree, gnostic
     return Subtree(
@@ -219,58 +486,111 @@ Json::Parser<T>::ParseList() {
     );
 }
 
-template <typename T>
+template <typename T, typename F>
 void
-Json::Parser<T>::ParsePair(
-    std::string & key,
-    Json::Parser<T>::ResultSet & value
+Json::Parser<T, F>::ParsePair(
+    tree_string_t & key,
+    Json::Parser<T, F>::ResultSet & value,
+    const Projection * projection
 ) {
     NextToken();
 
     if ((Token)_token != Token::STRING) {
         // Error, gnostic
-        value = Error("Expected a string");
+        value = Error(ErrorCode::EXPECTED_STRING, "Expected a string");
+        return;
+    }
+
+    key.assign(_lexer->String().data(), _lexer->String().size());
+
+    if (!Charge(key.size())) {
+        // Error, gnostic
+        value = Exceeded();
         return;
     }
 
-    key = _lexer->String();
     NextToken();
 
     if ((char)_token != ':') {
         // Error, gnostic
-        value = Error("Expected ':'");
+        value = Error(ErrorCode::EXPECTED_COLON, "Expected ':'");
         return;
     }
 
+    if (projection) {
+        projection = projection->Key(_lexer->String());
+
+        if (!projection) {
+            NextToken();
+
+            if (!Admit()) {
+                // Error, gnostic
+                value = Exceeded();
+                return;
+            }
+
+            // Skipped, agnostic
+            value = std::move(Skip());
+            return;
+        }
+
+        if (projection->IsLeaf())
+            projection = nullptr;
+    }
+
     // Subtree, agnostic
-    value = std::move(ParseValue());
+    value = std::move(ParseValue(projection));
 }
 
-template <typename T>
-typename Json::Parser<T>::ResultSet
-Json::Parser<T>::ParseValue() {
+template <typename T, typename F>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::ParseValue(const Projection * projection) {
     NextToken();
 
+    bool skip = projection && (
+        _token == '['
+            ? !projection->Items()
+            : _token == '{'
+                ? !projection->HasKeys()
+                : true
+    );
+
+    if (!Admit())
+        // Error, gnostic
+        return Exceeded();
+
+    if (skip)
+        // Skipped, agnostic
+        return Skip();
+
     if (_token == '[')
         // Subtree, agnostic
-        return ParseList();
+        return ParseList(
+            !projection || projection->Items()->IsLeaf()
+                ? nullptr
+                : projection->Items()
+        );
 
     if (_token == '{')
         // Subtree, agnostic
-        return ParseObject();
+        return ParseObject(projection);
 
     // Subtree, agnostic
     return ParsePrimitive();
 }
 
-template <typename T>
-typename Json::Parser<T>::ResultSet
-Json::Parser<T>::ParsePrimitive() {
+template <typename T, typename F>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::ParsePrimitive() {
     switch ((Token)_token) {
         case Token::WORD:
             // Subtree, agnostic
             return ParseKeyword();
         case Token::STRING:
+            if (!Charge(_lexer->String().size()))
+                // Error, gnostic
+                return Exceeded();
+
             // Subtree, gnostic
             return Subtree(
                 std::move(
@@ -289,12 +609,28 @@ Json::Parser<T>::ParsePrimitive() {
     return ParseNumber(false);
 }
 
-template <typename T>
-typename Json::Parser<T>::ResultSet
-Json::Parser<T>::ParseNumber(bool negative) {
+template <typename T, typename F>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::ParseNumber(bool negative) {
     int factor = negative ? -1 : 1;
 
     switch ((Token)_token) {
+        case Token::NUMBER:
+            _number = negative ? "-" : "";
+            _number += _lexer->String();
+
+            if (!Charge(_number.size()))
+                // Error, gnostic
+                return Exceeded();
+
+            // Subtree, gnostic
+            return Subtree(
+                std::move(
+                    _factory->NewNumeric(
+                        Homonumeric::Raw(_number.data(), (int)_number.size())
+                    )
+                )
+            );
         case Token::INTEGER:
             // Subtree, gnostic
             return Subtree(
@@ -318,12 +654,15 @@ Json::Parser<T>::ParseNumber(bool negative) {
     }
 
     // Error, gnostic
-    return Error("Expected a number (integer, float, or boolean)");
+    return Error(
+        ErrorCode::EXPECTED_NUMBER,
+        "Expected a number (integer, float, or boolean)"
+    );
 }
 
-template <typename T>
-typename Json::Parser<T>::ResultSet
-Json::Parser<T>::ParseKeyword() {
+template <typename T, typename F>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::ParseKeyword() {
     std::string keyword = _lexer->String();
 
     if (keyword == "null")
@@ -339,7 +678,10 @@ Json::Parser<T>::ParseKeyword() {
 
     if (!value)
         // Error, gnostic
-        return Error("Unexpected keyword '" + keyword + '\'');
+        return Error(
+            ErrorCode::UNEXPECTED_KEYWORD,
+            "Unexpected keyword '" + keyword + '\''
+        );
 
     // Subtree, gnostic
     return Subtree(
@@ -351,19 +693,264 @@ Json::Parser<T>::ParseKeyword() {
     );
 }
 
-template <typename T>
-typename Json::Parser<T>::ResultSet
-Json::Parser<T>::Error(const std::string & message) {
-    return ResultSet {
+// Scan functions follow the same grammar as the Parse functions,
+// but they report each value to the sink in document order instead
+// of calling the factory. With a NullSink, they copy no strings.
+// They charge every limit as the Parse functions do, so that a
+// sink that builds a Machine stays within the memory budget.
+template <typename T, typename F>
+template <typename S>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::Scan(S && sink) {
+    NextToken();
+
+    if (_token != '{')
+        // Error, gnostic
+        return Error(ErrorCode::EXPECTED_OPENING_BRACE, "Expected '{'");
+
+    if (!Admit())
+        // Error, gnostic
+        return Exceeded();
+
+    // Skipped, agnostic
+    return ScanObject(sink);
+}
+
+template <typename T, typename F>
+template <typename S>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::ScanObject(S && sink) {
+    if (!Descend() || !Charge(VALUE_BYTES))
+        // Error, gnostic
+        return Exceeded();
+
+    sink.StartObject();
+
+    do {
+        NextToken();
+
+        if ((Token)_token != Token::STRING)
+            // Error, gnostic
+            return Error(ErrorCode::EXPECTED_STRING, "Expected a string");
+
+        if (!Charge(_lexer->String().size()))
+            // Error, gnostic
+            return Exceeded();
+
+        sink.Key(_lexer->String());
+        NextToken();
+
+        if ((char)_token != ':')
+            // Error, gnostic
+            return Error(ErrorCode::EXPECTED_COLON, "Expected ':'");
+
+        NextToken();
+
+        if (!Admit())
+            // Error, gnostic
+            return Exceeded();
+
+        auto value = ScanValue(sink);
+
+        if (!value.Success)
+            // Error, agnostic
+            return value;
+
+        NextToken();
+    }
+    while (_token == ',');
+
+    if (_token != '}')
+        // Error, gnostic
+        return Error(ErrorCode::EXPECTED_CLOSING_BRACE, "Expected '}'");
+
+    Ascend();
+    sink.EndObject();
+
+    // Skipped, gnostic
+    return Skipped();
+}
+
+template <typename T, typename F>
+template <typename S>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::ScanList(S && sink) {
+    if (!Descend() || !Charge(VALUE_BYTES))
+        // Error, gnostic
+        return Exceeded();
+
+    sink.StartList();
+
+    do {
+        NextToken();
+
+        if (!Admit())
+            // Error, gnostic
+            return Exceeded();
+
+        auto value = ScanValue(sink);
+
+        if (!value.Success)
+            // Error, agnostic
+            return value;
+
+        NextToken();
+    }
+    while (_token == ',');
+
+    if (_token != ']')
+        // Error, gnostic
+        return Error(ErrorCode::EXPECTED_CLOSING_BRACKET, "Expected ']'");
+
+    Ascend();
+    sink.EndList();
+
+    // Skipped, gnostic
+    return Skipped();
+}
+
+template <typename T, typename F>
+template <typename S>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::ScanValue(S && sink) {
+    if (_token == '[')
+        // Skipped, agnostic
+        return ScanList(sink);
+
+    if (_token == '{')
+        // Skipped, agnostic
+        return ScanObject(sink);
+
+    int factor = 1;
+
+    switch ((Token)_token) {
+        case Token::STRING:
+            if (!Charge(_lexer->String().size() + VALUE_BYTES))
+                // Error, gnostic
+                return Exceeded();
+
+            sink.String(_lexer->String());
+
+            // Skipped, gnostic
+            return Skipped();
+        case Token::WORD:
+            {
+                const std::string & keyword = _lexer->String();
+
+                if (!Charge(VALUE_BYTES))
+                    // Error, gnostic
+                    return Exceeded();
+
+                if (keyword == "null")
+                    sink.Null();
+                else if (keyword == "false")
+                    sink.Numeric(Homonumeric::Boolean(false));
+                else if (keyword == "true")
+                    sink.Numeric(Homonumeric::Boolean(true));
+                else
+                    // Error, gnostic
+                    return Error(
+                        ErrorCode::UNEXPECTED_KEYWORD,
+                        "Unexpected keyword '" + keyword + '\''
+                    );
+
+                // Skipped, gnostic
+                return Skipped();
+            }
+        default:
+            if ((char)_token == '-') {
+                factor = -1;
+                NextToken();
+            }
+
+            break;
+    }
+
+    switch ((Token)_token) {
+        case Token::NUMBER:
+            _number = factor < 0 ? "-" : "";
+            _number += _lexer->String();
+
+            if (!Charge(_number.size() + VALUE_BYTES))
+                // Error, gnostic
+                return Exceeded();
+
+            sink.Numeric(Homonumeric::Raw(_number.data(), (int)_number.size()));
+
+            // Skipped, gnostic
+            return Skipped();
+        case Token::INTEGER:
+            if (!Charge(VALUE_BYTES))
+                // Error, gnostic
+                return Exceeded();
+
+            sink.Numeric(Homonumeric::Integer(factor * _lexer->Integer()));
+
+            // Skipped, gnostic
+            return Skipped();
+        case Token::FLOAT:
+            if (!Charge(VALUE_BYTES))
+                // Error, gnostic
+                return Exceeded();
+
+            sink.Numeric(Homonumeric::Float(factor * _lexer->Float()));
+
+            // Skipped, gnostic
+            return Skipped();
+        default:
+            break;
+    }
+
+    // Error, gnostic
+    return Error(
+        ErrorCode::EXPECTED_NUMBER,
+        "Expected a number (integer, float, or boolean)"
+    );
+}
+
+template <typename T, typename F>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::Error(
+    ErrorCode code,
+    const std::string & message
+) {
+    // A limit violation is reported over whatever error the
+    // grammar found after it
+    if (_exceeded != ErrorCode::NONE)
+        return Exceeded();
+
+    ResultSet result {
         false,
         nullptr,
         message
     };
+
+    result.Code = code;
+    result.Offset = _lexer->Index();
+    return result;
 }
 
-template <typename T>
-typename Json::Parser<T>::ResultSet
-Json::Parser<T>::Subtree(ptr_t && tree) {
+template <typename T, typename F>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::Exceeded() {
+    ResultSet result {
+        false,
+        nullptr,
+        ToString(_exceeded)
+    };
+
+    result.Code = _exceeded;
+    result.Offset = _lexer->Index();
+    return result;
+}
+
+template <typename T, typename F>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::Subtree(ptr_t && tree) {
+    if (!Charge(VALUE_BYTES))
+        // Error, gnostic
+        return Exceeded();
+
     return ResultSet {
         true,
         std::move(tree),
@@ -371,36 +958,80 @@ Json::Parser<T>::Subtree(ptr_t && tree) {
     };
 }
 
-template <typename T>
-typename Json::Parser<T>::ResultSet
-Json::Parser<T>::Tree(
-    std::unique_ptr<ITreeFactory<T>> factory,
+template <typename T, typename F>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::Skipped() {
+    ResultSet result {
+        true,
+        nullptr,
+        ""
+    };
+
+    result.Skipped = true;
+    return result;
+}
+
+template <typename T, typename F>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::Skip() {
+    _skipping = true;
+    auto result = ScanValue(NullSink());
+    _skipping = false;
+
+    // Skipped, agnostic
+    return result;
+}
+
+template <typename T, typename F>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::Tree(
+    std::unique_ptr<F> factory,
     std::shared_ptr<Lexer> lexer
 ) {
-    return Parser(factory, lexer).GetTree();
+    return Parser(std::move(factory), lexer).GetTree();
+}
+
+template <typename T, typename F>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::Tree(
+    std::shared_ptr<Lexer> lexer
+) {
+    return Parser(std::make_unique<F>(), lexer).GetTree();
+}
+
+template <typename T, typename F>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::Validate(
+    std::shared_ptr<Lexer> lexer,
+    const Limits & limits
+) {
+    // The grammar never reaches the factory
+    Parser parser(nullptr, lexer);
+    parser.SetLimits(limits);
+    return parser.Scan(NullSink());
 }
 
-template <typename T>
-template <typename F>
-typename Json::Parser<T>::ResultSet
-Json::Parser<T>::Tree(
+template <typename T, typename F>
+template <typename U>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::Tree(
     std::shared_ptr<Lexer> lexer
 ) {
-    return Parser<T>(
-        std::make_unique<F>(),
+    return Parser<T, F>(
+        std::make_unique<U>(),
         lexer
     )
     .GetTree();
 }
 
-template <typename T>
-template <template <class> class F>
-typename Json::Parser<T>::ResultSet
-Json::Parser<T>::Tree(
+template <typename T, typename F>
+template <template <class> class U>
+typename Json::Parser<T, F>::ResultSet
+Json::Parser<T, F>::Tree(
     std::shared_ptr<Lexer> lexer
 ) {
-    return Parser<T>(
-        std::make_unique<F<T>>(),
+    return Parser<T, F>(
+        std::make_unique<U<T>>(),
         lexer
     )
     .GetTree();
@@ -0,0 +1,449 @@
+#include "JsonPatch.h"
+#include <cstdio>
+
+namespace {
+    const char *
+    OpName(Json::PatchOperation::Kind op) {
+        switch (op) {
+            case Json::PatchOperation::ADD:
+                return "add";
+            case Json::PatchOperation::REMOVE:
+                return "remove";
+            default:
+                return "replace";
+        }
+    }
+
+    class Differ {
+        private:
+            const Json::Machine & _before;
+            const Json::Machine & _after;
+            Json::Patch & _patch;
+
+            // Whether equal hashes are confirmed by a walk
+            bool _confirm;
+
+            // Of the values being compared
+            std::string _path;
+
+            void
+            Emit(Json::PatchOperation::Kind op, Json::Pointer value = Json::Pointer()) {
+                if (op != Json::PatchOperation::REMOVE)
+                    value = _patch.Values.Copy(_after, value);
+
+                _patch.Operations.push_back(Json::PatchOperation { op, _path, value });
+            }
+
+            bool
+            Equal(Json::Pointer before, Json::Pointer after) {
+                // Containers by their cached hashes, scalars directly
+                if (before.type == after.type
+                    && (before.type == Json::Type::OBJECT
+                        || before.type == Json::Type::LIST)
+                ) {
+                    bool equal = _before.Hash(before) == _after.Hash(after);
+
+                    // Equal hashes are walked only when asked to confirm
+                    if (!equal || !_confirm)
+                        return equal;
+                }
+
+                return !Json::CompareValues(_before, before, _after, after);
+            }
+
+            void
+            DiffObjects(const Json::object_t & before, const Json::object_t & after) {
+                size_t length = _path.size();
+
+                for (size_t i = 0; i < before.size(); ++i) {
+                    auto & key = before.keys()[i];
+                    _path += '/' + Json::EscapePathToken(key);
+                    Json::Pointer value = after.at(key);
+
+                    if (!after.hasKey(key))
+                        Emit(Json::PatchOperation::REMOVE);
+                    else
+                        Diff(before.values()[i], value);
+
+                    _path.resize(length);
+                }
+
+                for (size_t i = 0; i < after.size(); ++i) {
+                    auto & key = after.keys()[i];
+
+                    if (before.hasKey(key))
+                        continue;
+
+                    _path += '/' + Json::EscapePathToken(key);
+                    Emit(Json::PatchOperation::ADD, after.values()[i]);
+                    _path.resize(length);
+                }
+            }
+
+            void
+            DiffLists(const Json::list_t & before, const Json::list_t & after) {
+                size_t length = _path.size();
+                size_t first = 0;
+                size_t beforeEnd = before.size();
+                size_t afterEnd = after.size();
+
+                // Skips the equal ends, so that an insertion or
+                // removal does not replace everything after it
+                while (first < beforeEnd && first < afterEnd
+                    && Equal(before[first], after[first])
+                )
+                    ++first;
+
+                while (beforeEnd > first && afterEnd > first
+                    && Equal(before[beforeEnd - 1], after[afterEnd - 1])
+                ) {
+                    --beforeEnd;
+                    --afterEnd;
+                }
+
+                size_t common = std::min(beforeEnd - first, afterEnd - first);
+
+                for (size_t i = 0; i < common; ++i) {
+                    _path += '/' + std::to_string(first + i);
+                    Diff(before[first + i], after[first + i]);
+                    _path.resize(length);
+                }
+
+                size_t index = first + common;
+
+                for (size_t i = index; i < afterEnd; ++i) {
+                    _path += '/' + std::to_string(i);
+                    Emit(Json::PatchOperation::ADD, after[i]);
+                    _path.resize(length);
+                }
+
+                // Each removal moves the rest down by one
+                for (size_t i = index; i < beforeEnd; ++i) {
+                    _path += '/' + std::to_string(index);
+                    Emit(Json::PatchOperation::REMOVE);
+                    _path.resize(length);
+                }
+            }
+        public:
+            Differ(
+                const Json::Machine & before,
+                const Json::Machine & after,
+                Json::Patch & patch,
+                bool confirm
+            ):  _before(before),
+                _after(after),
+                _patch(patch),
+                _confirm(confirm) {}
+
+            void
+            Diff(Json::Pointer before, Json::Pointer after) {
+                if (Equal(before, after))
+                    return;
+
+                if (before.type != after.type
+                    || (before.type != Json::Type::OBJECT
+                        && before.type != Json::Type::LIST)
+                ) {
+                    Emit(Json::PatchOperation::REPLACE, after);
+                    return;
+                }
+
+                if (before.type == Json::Type::OBJECT)
+                    DiffObjects(_before.Object(before.key), _after.Object(after.key));
+                else
+                    DiffLists(_before.List(before.key), _after.List(after.key));
+            }
+    };
+
+    // As a JSON string, escaped
+    std::string
+    Quote(std::string_view text) {
+        std::string quoted = "\"";
+
+        for (char c : text)
+            switch (c) {
+                case '"':
+                    quoted += "\\\"";
+                    break;
+                case '\\':
+                    quoted += "\\\\";
+                    break;
+                case '\b':
+                    quoted += "\\b";
+                    break;
+                case '\f':
+                    quoted += "\\f";
+                    break;
+                case '\n':
+                    quoted += "\\n";
+                    break;
+                case '\r':
+                    quoted += "\\r";
+                    break;
+                case '\t':
+                    quoted += "\\t";
+                    break;
+                default:
+                    if ((unsigned char)c < 0x20) {
+                        char code[8];
+                        std::snprintf(code, sizeof code, "\\u%04x", (unsigned)c);
+                        quoted += code;
+                    }
+                    else
+                        quoted += c;
+
+                    break;
+            }
+
+        return quoted + '"';
+    }
+
+    // As JSON text, laid out as ResultSet::ToString lays it out, but
+    // with strings escaped and null written out
+    std::string
+    ToJson(const Json::Machine & machine, Json::Pointer value) {
+        switch (value.type) {
+            case Json::Type::STRING:
+                return Quote(machine.String(value.key));
+            case Json::Type::NIL:
+                return "null";
+            case Json::Type::OBJECT:
+                {
+                    const auto & object = machine.Object(value.key);
+                    std::string text = "{";
+
+                    for (size_t i = 0; i < object.size(); ++i)
+                        text += (i ? ", " : " ") + Quote(object.keys()[i])
+                            + ": " + ToJson(machine, object.values()[i]);
+
+                    return text + " }";
+                }
+            case Json::Type::LIST:
+                {
+                    const auto & list = machine.List(value.key);
+                    std::string text = "[";
+
+                    for (size_t i = 0; i < list.size(); ++i)
+                        text += (i ? ", " : " ") + ToJson(machine, list[i]);
+
+                    return text + " ]";
+                }
+            default:
+                return machine.GetResultSet(value).ToString();
+        }
+    }
+
+    // Index into a list of the given size, or -1. "-" is the end.
+    long
+    ParseIndex(const std::string & token, size_t size, bool end) {
+        if (end && token == "-")
+            return (long)size;
+
+        if (token.empty() || token.size() > 9
+            || (token.size() > 1 && token[0] == '0')
+        )
+            return -1;
+
+        long index = 0;
+
+        for (char c : token) {
+            if (c < '0' || c > '9')
+                return -1;
+
+            index = index * 10 + (c - '0');
+        }
+
+        return index;
+    }
+}
+
+std::string
+Json::EscapePathToken(const std::string & token) {
+    if (token.find_first_of("~/") == std::string::npos)
+        return token;
+
+    std::string escaped;
+
+    for (char c : token)
+        if (c == '~')
+            escaped += "~0";
+        else if (c == '/')
+            escaped += "~1";
+        else
+            escaped += c;
+
+    return escaped;
+}
+
+std::vector<std::string>
+Json::SplitPath(const std::string & path) {
+    std::vector<std::string> tokens;
+
+    for (size_t i = 0; i < path.size();) {
+        // Past the '/'
+        size_t end = path.find('/', i + 1);
+
+        if (end == std::string::npos)
+            end = path.size();
+
+        std::string token;
+
+        for (size_t j = i + 1; j < end; ++j)
+            if (path[j] == '~' && j + 1 < end && path[j + 1] == '0')
+                token += '~', ++j;
+            else if (path[j] == '~' && j + 1 < end && path[j + 1] == '1')
+                token += '/', ++j;
+            else
+                token += path[j];
+
+        tokens.push_back(token);
+        i = end;
+    }
+
+    return tokens;
+}
+
+std::string
+Json::Patch::ToString() const {
+    std::string text = "[";
+
+    for (size_t i = 0; i < Operations.size(); ++i) {
+        auto & operation = Operations[i];
+
+        text += std::string(i ? ", " : " ")
+            + "{ \"op\": \"" + OpName(operation.Op)
+            + "\", \"path\": " + Quote(operation.Path);
+
+        if (operation.Op != PatchOperation::REMOVE)
+            text += ", \"value\": " + ToJson(Values, operation.Value);
+
+        text += " }";
+    }
+
+    return text + " ]";
+}
+
+Json::Patch
+Json::Machine::Diff(const Machine & other, bool confirm) const {
+    Patch patch;
+    Pointer before = GetResultSet()._pointer;
+    Pointer after = other.GetResultSet()._pointer;
+
+    Differ(*this, other, patch, confirm).Diff(before, after);
+    return patch;
+}
+
+bool
+Json::Machine::Apply(const Patch & patch) {
+    Machine patched(*this);
+
+    if (!patched.ApplyInPlace(patch))
+        return false;
+
+    *this = std::move(patched);
+    return true;
+}
+
+bool
+Json::Machine::ApplyInPlace(const Patch & patch) {
+    if (_start < 0 && !_objects.empty())
+        SetStartingObject((key_t)_objects.size() - 1);
+
+    Offsets offsets = Append(patch.Values);
+
+    for (auto & operation : patch.Operations) {
+        auto tokens = SplitPath(operation.Path);
+        Pointer value = offsets.Rebase(operation.Value);
+
+        if (tokens.empty()) {
+            // The whole document
+            if (operation.Op == PatchOperation::REMOVE
+                || value.type != Type::OBJECT
+            )
+                return false;
+
+            SetStartingObject(value.key);
+            continue;
+        }
+
+        Pointer parent = GetResultSet()._pointer;
+
+        for (size_t i = 0; i + 1 < tokens.size(); ++i) {
+            if (parent.type == Type::OBJECT) {
+                const auto & object = std::as_const(*this).Object(parent.key);
+
+                if (!object.hasKey(tokens[i]))
+                    return false;
+
+                parent = object.at(tokens[i]);
+            }
+            else if (parent.type == Type::LIST) {
+                const auto & list = std::as_const(*this).List(parent.key);
+                long index = ParseIndex(tokens[i], list.size(), false);
+
+                if (index < 0 || index >= (long)list.size())
+                    return false;
+
+                parent = list[index];
+            }
+            else
+                return false;
+        }
+
+        auto & token = tokens.back();
+
+        if (parent.type == Type::OBJECT) {
+            auto & object = Object(parent.key);
+
+            switch (operation.Op) {
+                case PatchOperation::ADD:
+                    object[token] = value;
+                    break;
+                case PatchOperation::REPLACE:
+                    if (!object.hasKey(token))
+                        return false;
+
+                    object[token] = value;
+                    break;
+                default:
+                    if (!object.erase(token))
+                        return false;
+
+                    break;
+            }
+        }
+        else if (parent.type == Type::LIST) {
+            auto & list = List(parent.key);
+
+            long index = ParseIndex(
+                token,
+                list.size(),
+                operation.Op == PatchOperation::ADD
+            );
+
+            long size = (long)list.size();
+
+            if (index < 0
+                || index > size
+                || (operation.Op != PatchOperation::ADD && index == size)
+            )
+                return false;
+
+            switch (operation.Op) {
+                case PatchOperation::ADD:
+                    list.insert(index, value);
+                    break;
+                case PatchOperation::REPLACE:
+                    list.set(index, value);
+                    break;
+                default:
+                    list.erase(index);
+                    break;
+            }
+        }
+        else
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#ifndef _JSONPATCH_H
+#define _JSONPATCH_H
+
+#include "JsonMachine.h"
+
+namespace Json {
+    // One operation of a JSON Patch (RFC 6902). A diff emits only
+    // add, remove and replace.
+    struct PatchOperation {
+        enum Kind {
+            ADD,
+            REMOVE,
+            REPLACE
+        };
+
+        Kind Op;
+
+        // JSON Pointer (RFC 6901)
+        std::string Path;
+
+        // Into Patch::Values; null for a remove
+        Pointer Value;
+    };
+
+    struct Patch {
+        std::vector<PatchOperation> Operations;
+
+        // Every value added or replaced by the operations
+        Machine Values;
+
+        // As the JSON text of RFC 6902
+        std::string ToString() const;
+    };
+
+    // Splits a JSON Pointer into its reference tokens, undoing the
+    // ~0 and ~1 escapes
+    std::vector<std::string> SplitPath(const std::string &);
+
+    std::string EscapePathToken(const std::string &);
+};
+
+#endif
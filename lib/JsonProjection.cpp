@@ -0,0 +1,111 @@
+#include "JsonProjection.h"
+
+Json::Projection::Projection():
+    _all(false) {}
+
+Json::Projection &
+Json::Projection::Child(const std::string & name) {
+    for (size_t i = 0; i < _names.size(); ++i)
+        if (!_names[i].compare(name))
+            return _children[i];
+
+    _names.push_back(name);
+    _children.push_back(Projection());
+    return _children.back();
+}
+
+Json::Projection &
+Json::Projection::ItemsChild() {
+    if (!_items)
+        _items = std::make_unique<Projection>();
+
+    return *_items;
+}
+
+bool
+Json::Projection::Add(const std::string & path) {
+    // Starting position:
+    //   v
+    //   PERSONS[*].WEEK[*].NUMBER
+    //
+    // Ending position:
+    //                            v
+    //   PERSONS[*].WEEK[*].NUMBER
+    //
+    Projection * node = this;
+    size_t pos = 0;
+
+    while (pos < path.size()) {
+        size_t end = path.find_first_of(".[", pos);
+
+        if (end == std::string::npos)
+            end = path.size();
+
+        if (end == pos)
+            return false;
+
+        node = &node->Child(path.substr(pos, end - pos));
+        pos = end;
+
+        while (pos < path.size() && path[pos] == '[') {
+            if (path.compare(pos, 3, "[*]"))
+                return false;
+
+            node = &node->ItemsChild();
+            pos = pos + 3;
+        }
+
+        if (pos == path.size())
+            break;
+
+        if (path[pos] != '.' || pos + 1 == path.size())
+            return false;
+
+        pos = pos + 1;
+    }
+
+    if (node == this)
+        return false;
+
+    node->_all = true;
+    return true;
+}
+
+bool
+Json::Projection::IsLeaf() const {
+    return _all;
+}
+
+bool
+Json::Projection::HasKeys() const {
+    return !_names.empty();
+}
+
+const Json::Projection *
+Json::Projection::Key(const std::string & name) const {
+    for (size_t i = 0; i < _names.size(); ++i)
+        if (!_names[i].compare(name))
+            return &_children[i];
+
+    return nullptr;
+}
+
+const Json::Projection *
+Json::Projection::Items() const {
+    return _items.get();
+}
+
+bool
+Json::Projection::New(
+    const std::vector<std::string> & paths,
+    Projection & projection
+) {
+    Projection temp;
+
+    for (auto & path : paths)
+        if (!temp.Add(path))
+            return false;
+
+    projection = std::move(temp);
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#ifndef _JSONPROJECTION_H
+#define _JSONPROJECTION_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Json {
+    // Set of paths to materialize, e.g.
+    //
+    //   PERSONS[*].WHO
+    //   PERSONS[*].WEEK[*].EXPENSE[*].AMOUNT
+    //
+    // Every path names a branch from the starting object. Values
+    // on no path are still validated by the parser, but they are
+    // skipped without being built.
+    class Projection {
+        private:
+            std::vector<std::string>
+            _names;
+
+            std::vector<Projection>
+            _children;
+
+            std::unique_ptr<Projection>
+            _items;
+
+            bool
+            _all;
+
+            Projection & Child(const std::string &);
+            Projection & ItemsChild();
+        public:
+            virtual ~Projection() = default;
+            Projection();
+            Projection(Projection &&) = default;
+            Projection & operator=(Projection &&) = default;
+
+            bool Add(const std::string & path);
+
+            // Selects the whole subtree
+            bool IsLeaf() const;
+            bool HasKeys() const;
+
+            const Projection * Key(const std::string &) const;
+            const Projection * Items() const;
+
+            static bool New(
+                const std::vector<std::string> & paths,
+                Projection & projection
+            );
+    };
+};
+
+#endif
@@ -0,0 +1,661 @@
+#include "JsonSnapshot.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#if defined(_WIN32)
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const char SNAPSHOT_MAGIC[8] = { 'J', 'S', 'O', 'N', 'S', 'N', 'A', 'P' };
+    const size_t SNAPSHOT_ALIGNMENT = 8;
+
+    template <typename T>
+    void
+    Put(std::string & section, T value) {
+        section.append((const char *)&value, sizeof value);
+    }
+
+    size_t
+    Align(size_t offset) {
+        return (offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+    }
+}
+
+bool
+Json::Machine::SaveSnapshot(const std::string & path) const {
+    typedef SnapshotHeader H;
+    std::string sections[H::SECTION_COUNT];
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof header);
+    std::memcpy(header.Magic, SNAPSHOT_MAGIC, sizeof header.Magic);
+    header.Version = H::VERSION;
+    header.Start = _start;
+
+    // Interned strings keep sharing their bytes
+    auto & stringBytes = sections[H::STRING_BYTES];
+    stringBytes = _string_heap;
+
+    for (key_t i = 0; i < StringCount(); ++i) {
+        uint64_t offset = 0;
+        uint64_t length = 0;
+
+        if (!_string_slots.empty() && _string_slots[i] >= 0) {
+            auto & entry = _interned[_string_slots[i]];
+            offset = entry.Offset;
+            length = entry.Length;
+        }
+        else {
+            auto text = String(i);
+            offset = stringBytes.size();
+            length = text.size();
+            stringBytes.append(text.data(), text.size());
+        }
+
+        Put(sections[H::STRINGS], offset);
+        Put(sections[H::STRINGS], length);
+    }
+
+    for (key_t i = 0; i < (key_t)_integers.size(); ++i)
+        Put(sections[H::INTEGERS], Integer(i));
+
+    for (key_t i = 0; i < (key_t)_floats.size(); ++i)
+        Put(sections[H::FLOATS], Float(i));
+
+    for (size_t i = 0; i < _booleans.size(); ++i)
+        Put(sections[H::BOOLEANS], (uint8_t)_booleans[i]);
+
+    if (!_raw_numbers.empty()) {
+        auto putText = [&](Pointer pointer) {
+            auto text = SourceText(pointer);
+            Put(sections[H::NUMBERS], (uint64_t)sections[H::NUMBER_BYTES].size());
+            Put(sections[H::NUMBERS], (uint64_t)text.size());
+            sections[H::NUMBER_BYTES].append(text.data(), text.size());
+        };
+
+        for (key_t i = 0; i < (key_t)_integers.size(); ++i)
+            putText(Pointer { Type::INTEGER, i });
+
+        for (key_t i = 0; i < (key_t)_floats.size(); ++i)
+            putText(Pointer { Type::FLOAT, i });
+    }
+
+    bool wide = false;
+
+    for (auto & list : _lists)
+        wide = wide || list.wide();
+
+    for (auto & object : _objects)
+        wide = wide || object.values().wide();
+
+    header.PointerWords = wide ? 2 : 1;
+
+    auto putPointer = [&](std::string & section, Pointer pointer) {
+        if (wide) {
+            Put(section, (uint32_t)pointer.type);
+            Put(section, (uint32_t)pointer.key);
+        }
+        else
+            Put(section, PointerList::pack(pointer));
+    };
+
+    uint64_t count = 0;
+
+    for (auto & list : _lists) {
+        Put(sections[H::LISTS], count);
+        count = count + list.size();
+
+        for (Pointer pointer : list)
+            putPointer(sections[H::LIST_WORDS], pointer);
+    }
+
+    Put(sections[H::LISTS], count);
+
+    std::unordered_map<const object_t::shape_t *, uint32_t> shapes;
+    std::unordered_map<std::string, uint32_t> keys;
+    uint64_t shapeKeys = 0;
+    count = 0;
+
+    for (auto & object : _objects) {
+        auto & shape = *object.shape();
+        auto found = shapes.find(&shape);
+
+        if (found == shapes.end()) {
+            found = shapes.emplace(&shape, (uint32_t)shapes.size()).first;
+            Put(sections[H::SHAPES], shapeKeys);
+            shapeKeys = shapeKeys + shape.size();
+
+            for (auto & key : shape.keys()) {
+                auto id = keys.emplace(key, (uint32_t)keys.size());
+
+                if (id.second) {
+                    Put(sections[H::KEYS], (uint64_t)sections[H::KEY_BYTES].size());
+                    sections[H::KEY_BYTES].append(key);
+                }
+
+                Put(sections[H::SHAPE_KEYS], id.first->second);
+            }
+
+            std::vector<uint32_t> order(shape.size());
+
+            for (uint32_t i = 0; i < order.size(); ++i)
+                order[i] = i;
+
+            std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                return shape.keys()[a] < shape.keys()[b];
+            });
+
+            for (auto position : order)
+                Put(sections[H::SHAPE_ORDER], position);
+        }
+
+        Put(sections[H::OBJECTS], count);
+        Put(sections[H::OBJECT_SHAPES], found->second);
+        count = count + object.size();
+
+        for (Pointer pointer : object.values())
+            putPointer(sections[H::OBJECT_WORDS], pointer);
+    }
+
+    Put(sections[H::OBJECTS], count);
+    Put(sections[H::SHAPES], shapeKeys);
+    Put(sections[H::KEYS], (uint64_t)sections[H::KEY_BYTES].size());
+
+    header.Strings = StringCount();
+    header.Integers = _integers.size();
+    header.Floats = _floats.size();
+    header.Booleans = _booleans.size();
+    header.Lists = _lists.size();
+    header.Objects = _objects.size();
+    header.Shapes = shapes.size();
+    header.Keys = keys.size();
+
+    size_t offset = Align(sizeof header);
+
+    for (int i = 0; i < H::SECTION_COUNT; ++i) {
+        header.Offsets[i] = offset;
+        header.Sizes[i] = sections[i].size();
+        offset = Align(offset + sections[i].size());
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write((const char *)&header, sizeof header);
+    size_t written = sizeof header;
+
+    for (int i = 0; i < H::SECTION_COUNT; ++i) {
+        static const char padding[SNAPSHOT_ALIGNMENT] = {};
+        out.write(padding, header.Offsets[i] - written);
+        out.write(sections[i].data(), sections[i].size());
+        written = header.Offsets[i] + sections[i].size();
+    }
+
+    return out.good();
+}
+
+Json::MappedMachine::MappedMachine():
+    _data(nullptr),
+    _size(0),
+    _header(nullptr) {}
+
+Json::MappedMachine::~MappedMachine() {
+#if !defined(_WIN32)
+    if (_data && _buffer.empty())
+        munmap((void *)_data, _size);
+#endif
+}
+
+std::shared_ptr<const Json::MappedMachine>
+Json::MappedMachine::Open(const std::string & path) {
+    std::shared_ptr<MappedMachine> machine(new MappedMachine());
+
+#if defined(_WIN32)
+    // Read instead of mapped
+    std::ifstream in(path, std::ios::binary);
+
+    if (!in)
+        return nullptr;
+
+    machine->_buffer.assign(
+        std::istreambuf_iterator<char>(in),
+        std::istreambuf_iterator<char>()
+    );
+
+    machine->_data = machine->_buffer.data();
+    machine->_size = machine->_buffer.size();
+#else
+    int file = open(path.c_str(), O_RDONLY);
+
+    if (file < 0)
+        return nullptr;
+
+    struct stat status;
+
+    if (fstat(file, &status) || status.st_size < (off_t)sizeof(SnapshotHeader)) {
+        close(file);
+        return nullptr;
+    }
+
+    void * data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+
+    if (data == MAP_FAILED)
+        return nullptr;
+
+    machine->_data = (const char *)data;
+    machine->_size = status.st_size;
+#endif
+
+    machine->_header = (const SnapshotHeader *)machine->_data;
+
+    if (!machine->Check())
+        return nullptr;
+
+    return machine;
+}
+
+bool
+Json::MappedMachine::Check() const {
+    typedef SnapshotHeader H;
+
+    if (_size < sizeof(SnapshotHeader)
+        || std::memcmp(_header->Magic, SNAPSHOT_MAGIC, sizeof SNAPSHOT_MAGIC)
+        || _header->Version != H::VERSION
+        || (_header->PointerWords != 1 && _header->PointerWords != 2)
+    )
+        return false;
+
+    for (int i = 0; i < H::SECTION_COUNT; ++i)
+        if (_header->Offsets[i] % SNAPSHOT_ALIGNMENT
+            || _header->Offsets[i] > _size
+            || _header->Sizes[i] > _size - _header->Offsets[i]
+        )
+            return false;
+
+    // Every count is no larger than the file, so none of the
+    // products below can overflow
+    const uint64_t counts[] = {
+        _header->Strings, _header->Integers, _header->Floats,
+        _header->Booleans, _header->Lists, _header->Objects,
+        _header->Shapes, _header->Keys
+    };
+
+    for (uint64_t count : counts)
+        if (count > _size || count > (uint64_t)std::numeric_limits<key_t>::max())
+            return false;
+
+    uint64_t numbers = _header->Integers + _header->Floats;
+    uint64_t pointerBytes = sizeof(uint32_t) * _header->PointerWords;
+
+    if (_header->Sizes[H::STRINGS] != 2 * sizeof(uint64_t) * _header->Strings
+        || _header->Sizes[H::INTEGERS] != sizeof(int) * _header->Integers
+        || _header->Sizes[H::FLOATS] != sizeof(float) * _header->Floats
+        || _header->Sizes[H::BOOLEANS] != _header->Booleans
+        || (_header->Sizes[H::NUMBERS]
+            && _header->Sizes[H::NUMBERS] != 2 * sizeof(uint64_t) * numbers)
+        || _header->Sizes[H::LISTS] != sizeof(uint64_t) * (_header->Lists + 1)
+        || _header->Sizes[H::LIST_WORDS] % pointerBytes
+        || _header->Sizes[H::OBJECTS] != sizeof(uint64_t) * (_header->Objects + 1)
+        || _header->Sizes[H::OBJECT_SHAPES] != sizeof(uint32_t) * _header->Objects
+        || _header->Sizes[H::OBJECT_WORDS] % pointerBytes
+        || _header->Sizes[H::SHAPES] != sizeof(uint64_t) * (_header->Shapes + 1)
+        || _header->Sizes[H::SHAPE_KEYS] % sizeof(uint32_t)
+        || _header->Sizes[H::SHAPE_ORDER] != _header->Sizes[H::SHAPE_KEYS]
+        || _header->Sizes[H::KEYS] != sizeof(uint64_t) * (_header->Keys + 1)
+    )
+        return false;
+
+    // Of the object at Start, or -1 for the last one
+    if (_header->Start < -1
+        || (_header->Start >= 0 && (uint64_t)_header->Start >= _header->Objects)
+    )
+        return false;
+
+    // A table of first entries rises from 0 to the end of the
+    // section it indexes
+    auto checkOffsets = [&](H::Section section, uint64_t count, uint64_t end) {
+        auto offsets = Section<uint64_t>(section);
+
+        for (uint64_t i = 0; i < count; ++i)
+            if (offsets[i] > offsets[i + 1])
+                return false;
+
+        return !offsets[0] && offsets[count] == end;
+    };
+
+    // Each (offset, length) lies within the bytes
+    auto checkSpans = [&](H::Section spans, H::Section bytes, uint64_t count) {
+        auto span = Section<uint64_t>(spans);
+        uint64_t size = _header->Sizes[bytes];
+
+        for (uint64_t i = 0; i < count; ++i)
+            if (span[2 * i] > size || span[2 * i + 1] > size - span[2 * i])
+                return false;
+
+        return true;
+    };
+
+    // Each word holds a value of a known type, in range
+    auto checkWords = [&](H::Section section) {
+        MappedList words(
+            Section<uint32_t>(section),
+            _header->Sizes[section] / pointerBytes,
+            _header->PointerWords
+        );
+
+        for (Pointer value : words) {
+            uint64_t limit = 0;
+
+            switch (value.type) {
+                case Type::STRING:
+                    limit = _header->Strings;
+                    break;
+                case Type::INTEGER:
+                    limit = _header->Integers;
+                    break;
+                case Type::FLOAT:
+                    limit = _header->Floats;
+                    break;
+                case Type::BOOLEAN:
+                    limit = _header->Booleans;
+                    break;
+                case Type::OBJECT:
+                    limit = _header->Objects;
+                    break;
+                case Type::LIST:
+                    limit = _header->Lists;
+                    break;
+                case Type::NIL:
+                    continue;
+                default:
+                    return false;
+            }
+
+            if (value.key < 0 || (uint64_t)value.key >= limit)
+                return false;
+        }
+
+        return true;
+    };
+
+    if (!checkOffsets(H::LISTS, _header->Lists, _header->Sizes[H::LIST_WORDS] / pointerBytes)
+        || !checkOffsets(H::OBJECTS, _header->Objects, _header->Sizes[H::OBJECT_WORDS] / pointerBytes)
+        || !checkOffsets(H::SHAPES, _header->Shapes, _header->Sizes[H::SHAPE_KEYS] / sizeof(uint32_t))
+        || !checkOffsets(H::KEYS, _header->Keys, _header->Sizes[H::KEY_BYTES])
+        || !checkSpans(H::STRINGS, H::STRING_BYTES, _header->Strings)
+        || (_header->Sizes[H::NUMBERS]
+            && !checkSpans(H::NUMBERS, H::NUMBER_BYTES, numbers))
+        || !checkWords(H::LIST_WORDS)
+        || !checkWords(H::OBJECT_WORDS)
+    )
+        return false;
+
+    auto shapeOffsets = Section<uint64_t>(H::SHAPES);
+    auto shapeKeys = Section<uint32_t>(H::SHAPE_KEYS);
+    auto shapeOrder = Section<uint32_t>(H::SHAPE_ORDER);
+
+    for (uint64_t i = 0; i < _header->Shapes; ++i) {
+        uint64_t size = shapeOffsets[i + 1] - shapeOffsets[i];
+
+        for (uint64_t j = shapeOffsets[i]; j < shapeOffsets[i + 1]; ++j)
+            if (shapeKeys[j] >= _header->Keys || shapeOrder[j] >= size)
+                return false;
+    }
+
+    // An object has as many values as its shape has keys
+    auto objectOffsets = Section<uint64_t>(H::OBJECTS);
+    auto objectShapes = Section<uint32_t>(H::OBJECT_SHAPES);
+
+    for (uint64_t i = 0; i < _header->Objects; ++i) {
+        uint32_t shape = objectShapes[i];
+
+        if (shape >= _header->Shapes
+            || objectOffsets[i + 1] - objectOffsets[i]
+                != shapeOffsets[shape + 1] - shapeOffsets[shape]
+        )
+            return false;
+    }
+
+    return true;
+}
+
+template <typename T>
+const T *
+Json::MappedMachine::Section(SnapshotHeader::Section section) const {
+    return (const T *)(_data + _header->Offsets[section]);
+}
+
+std::string_view
+Json::MappedMachine::Span(
+    SnapshotHeader::Section spans,
+    SnapshotHeader::Section bytes,
+    size_t index
+) const {
+    auto span = Section<uint64_t>(spans) + 2 * index;
+    return std::string_view(Section<char>(bytes) + span[0], span[1]);
+}
+
+std::string_view
+Json::MappedMachine::Key(uint32_t id) const {
+    auto offsets = Section<uint64_t>(SnapshotHeader::KEYS);
+
+    return std::string_view(
+        Section<char>(SnapshotHeader::KEY_BYTES) + offsets[id],
+        offsets[id + 1] - offsets[id]
+    );
+}
+
+size_t
+Json::MappedMachine::Size() const {
+    return _size;
+}
+
+Json::key_t
+Json::MappedMachine::StringCount() const {
+    return (key_t)_header->Strings;
+}
+
+Json::key_t
+Json::MappedMachine::ListCount() const {
+    return (key_t)_header->Lists;
+}
+
+Json::key_t
+Json::MappedMachine::ObjectCount() const {
+    return (key_t)_header->Objects;
+}
+
+Json::MappedList
+Json::MappedMachine::List(key_t key) const {
+    auto offsets = Section<uint64_t>(SnapshotHeader::LISTS);
+
+    return MappedList(
+        Section<uint32_t>(SnapshotHeader::LIST_WORDS)
+            + offsets[key] * _header->PointerWords,
+        offsets[key + 1] - offsets[key],
+        _header->PointerWords
+    );
+}
+
+Json::MappedObject
+Json::MappedMachine::Object(key_t key) const {
+    auto offsets = Section<uint64_t>(SnapshotHeader::OBJECTS);
+
+    return MappedObject(
+        this,
+        Section<uint32_t>(SnapshotHeader::OBJECT_SHAPES)[key],
+        MappedList(
+            Section<uint32_t>(SnapshotHeader::OBJECT_WORDS)
+                + offsets[key] * _header->PointerWords,
+            offsets[key + 1] - offsets[key],
+            _header->PointerWords
+        )
+    );
+}
+
+std::string_view
+Json::MappedMachine::String(key_t key) const {
+    return Span(SnapshotHeader::STRINGS, SnapshotHeader::STRING_BYTES, key);
+}
+
+int
+Json::MappedMachine::Integer(key_t key) const {
+    return Section<int>(SnapshotHeader::INTEGERS)[key];
+}
+
+float
+Json::MappedMachine::Float(key_t key) const {
+    return Section<float>(SnapshotHeader::FLOATS)[key];
+}
+
+bool
+Json::MappedMachine::Boolean(key_t key) const {
+    return Section<uint8_t>(SnapshotHeader::BOOLEANS)[key];
+}
+
+std::string_view
+Json::MappedMachine::SourceText(Pointer pointer) const {
+    if (!_header->Sizes[SnapshotHeader::NUMBERS])
+        return std::string_view();
+
+    switch (pointer.type) {
+        case Type::INTEGER:
+            return Span(SnapshotHeader::NUMBERS, SnapshotHeader::NUMBER_BYTES, pointer.key);
+        case Type::FLOAT:
+            return Span(
+                SnapshotHeader::NUMBERS,
+                SnapshotHeader::NUMBER_BYTES,
+                _header->Integers + pointer.key
+            );
+        default:
+            return std::string_view();
+    }
+}
+
+uint64_t
+Json::MappedMachine::Hash(Pointer value) const {
+    // Only the lists and objects under the value
+    std::unordered_map<uint64_t, uint64_t> hashes;
+
+    return HashValue(*this, value, [&](Pointer container) -> uint64_t & {
+        return hashes[((uint64_t)container.type << 32) | (uint32_t)container.key];
+    });
+}
+
+Json::FieldIndex
+Json::MappedMachine::HashIndex(key_t list, const std::string & field) const {
+    FieldIndex index;
+    IndexHashes(index, *this, list, field);
+    return index;
+}
+
+Json::FieldIndex
+Json::MappedMachine::OrderedIndex(key_t list, const std::string & field) const {
+    FieldIndex index;
+    IndexNumbers(index, *this, list, field);
+    return index;
+}
+
+Json::MappedMachine::result_set_t
+Json::MappedMachine::GetResultSet() const {
+    return GetResultSet(_header->Start);
+}
+
+Json::MappedMachine::result_set_t
+Json::MappedMachine::GetResultSet(key_t start) const {
+    if (!_header->Objects)
+        return result_set_t(this, Pointer { Type::NIL, 0 });
+
+    return result_set_t(this, Pointer {
+        Type::OBJECT,
+        start < 0 ? (key_t)_header->Objects - 1 : start
+    });
+}
+
+size_t
+Json::MappedKeys::size() const {
+    return _size;
+}
+
+std::string_view
+Json::MappedKeys::operator[](size_t index) const {
+    return _machine->Key(_ids[index]);
+}
+
+size_t
+Json::MappedObject::size() const {
+    return _values.size();
+}
+
+Json::MappedKeys
+Json::MappedObject::keys() const {
+    auto offsets = _machine->Section<uint64_t>(SnapshotHeader::SHAPES);
+
+    return MappedKeys(
+        _machine,
+        _machine->Section<uint32_t>(SnapshotHeader::SHAPE_KEYS) + offsets[_shape],
+        offsets[_shape + 1] - offsets[_shape]
+    );
+}
+
+const Json::MappedList &
+Json::MappedObject::values() const {
+    return _values;
+}
+
+int
+Json::MappedObject::find(std::string_view key) const {
+    auto names = keys();
+
+    if (names.size() <= object_t::shape_t::INDEX_THRESHOLD) {
+        for (int i = 0; i < (int)names.size(); ++i)
+            if (names[i] == key)
+                return i;
+
+        return -1;
+    }
+
+    auto offsets = _machine->Section<uint64_t>(SnapshotHeader::SHAPES);
+    auto order = _machine->Section<uint32_t>(SnapshotHeader::SHAPE_ORDER)
+        + offsets[_shape];
+
+    size_t low = 0;
+    size_t high = names.size();
+
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+        int compare = names[order[middle]].compare(key);
+
+        if (!compare)
+            return (int)order[middle];
+
+        if (compare < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return -1;
+}
+
+bool
+Json::MappedObject::hasKey(const std::string & key) const {
+    return find(key) >= 0;
+}
+
+Json::Pointer
+Json::MappedObject::at(const std::string & key) const {
+    int position = find(key);
+
+    if (position >= 0)
+        return _values[position];
+
+    return Pointer();
+}
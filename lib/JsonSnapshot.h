@@ -0,0 +1,284 @@
+#pragma once
+#ifndef _JSONSNAPSHOT_H
+#define _JSONSNAPSHOT_H
+
+#include "JsonMachine.h"
+#include <cstdint>
+#include <string_view>
+
+namespace Json {
+    // Layout of a file written by Machine::SaveSnapshot.
+    //
+    // A fixed header is followed by the sections, each starting on
+    // an 8-byte boundary. Every reference between sections is an
+    // index or an offset, so the file can be used where it is
+    // mapped. Integers are stored in the byte order of the machine
+    // that wrote them.
+    //
+    //   STRINGS         (offset, length) per string, 64 bits each
+    //   STRING_BYTES    bytes of every string
+    //   INTEGERS        int per integer
+    //   FLOATS          float per float
+    //   BOOLEANS        one byte per boolean
+    //   NUMBERS         (offset, length) of the source text of each
+    //                   integer, then each float. Length 0 if none.
+    //   NUMBER_BYTES    bytes of every source text
+    //   LISTS           first element of each list, plus the end
+    //   LIST_WORDS      elements of every list
+    //   OBJECTS         first value of each object, plus the end
+    //   OBJECT_SHAPES   shape of each object, 32 bits
+    //   OBJECT_WORDS    values of every object
+    //   SHAPES          first key of each shape, plus the end
+    //   SHAPE_KEYS      key of each position of every shape, 32 bits
+    //   SHAPE_ORDER     positions of every shape, sorted by key
+    //   KEYS            first byte of each distinct key, plus the end
+    //   KEY_BYTES       bytes of every key
+    //
+    // Element and value words are PointerList words: 32 bits each,
+    // or, when the header says so, two 32-bit words of type and key.
+    struct SnapshotHeader {
+        enum Section {
+            STRINGS,
+            STRING_BYTES,
+            INTEGERS,
+            FLOATS,
+            BOOLEANS,
+            NUMBERS,
+            NUMBER_BYTES,
+            LISTS,
+            LIST_WORDS,
+            OBJECTS,
+            OBJECT_SHAPES,
+            OBJECT_WORDS,
+            SHAPES,
+            SHAPE_KEYS,
+            SHAPE_ORDER,
+            KEYS,
+            KEY_BYTES,
+            SECTION_COUNT
+        };
+
+        static const uint32_t VERSION = 1;
+
+        char Magic[8];
+        uint32_t Version;
+
+        // 1 for one word per Pointer, 2 for two
+        uint32_t PointerWords;
+
+        int32_t Start;
+        uint32_t Padding;
+
+        uint64_t Strings;
+        uint64_t Integers;
+        uint64_t Floats;
+        uint64_t Booleans;
+        uint64_t Lists;
+        uint64_t Objects;
+        uint64_t Shapes;
+        uint64_t Keys;
+
+        // Into the file
+        uint64_t Offsets[SECTION_COUNT];
+        uint64_t Sizes[SECTION_COUNT];
+    };
+
+    // Elements of a list in a snapshot
+    class MappedList {
+        private:
+            const uint32_t * _words;
+            size_t _size;
+            uint32_t _pointer_words;
+        public:
+            class const_iterator {
+                private:
+                    const MappedList * _list;
+                    size_t _index;
+                public:
+                    const_iterator(const MappedList * list, size_t index):
+                        _list(list),
+                        _index(index) {}
+
+                    Pointer
+                    operator*() const {
+                        return (*_list)[_index];
+                    }
+
+                    const_iterator &
+                    operator++() {
+                        ++_index;
+                        return *this;
+                    }
+
+                    bool
+                    operator!=(const const_iterator & other) const {
+                        return _index != other._index;
+                    }
+            };
+
+            MappedList(const uint32_t * words, size_t size, uint32_t pointerWords):
+                _words(words),
+                _size(size),
+                _pointer_words(pointerWords) {}
+
+            size_t
+            size() const {
+                return _size;
+            }
+
+            bool
+            empty() const {
+                return !_size;
+            }
+
+            Pointer
+            operator[](size_t index) const {
+                if (_pointer_words == 2)
+                    return Pointer {
+                        (Type)_words[2 * index],
+                        (key_t)_words[2 * index + 1]
+                    };
+
+                return PointerList::unpack(_words[index]);
+            }
+
+            Pointer
+            at(size_t index) const {
+                if (index >= _size)
+                    throw std::out_of_range("MappedList::at");
+
+                return (*this)[index];
+            }
+
+            const_iterator
+            begin() const {
+                return const_iterator(this, 0);
+            }
+
+            const_iterator
+            end() const {
+                return const_iterator(this, _size);
+            }
+    };
+
+    // Keys of an object in a snapshot, in order
+    class MappedKeys {
+        private:
+            const MappedMachine * _machine;
+            const uint32_t * _ids;
+            size_t _size;
+        public:
+            MappedKeys(const MappedMachine * machine, const uint32_t * ids, size_t size):
+                _machine(machine),
+                _ids(ids),
+                _size(size) {}
+
+            size_t size() const;
+            std::string_view operator[](size_t) const;
+    };
+
+    // Object in a snapshot. Looks up keys by scanning small shapes
+    // and by binary search over the sorted positions of larger ones.
+    class MappedObject {
+        private:
+            const MappedMachine * _machine;
+            uint32_t _shape;
+            MappedList _values;
+        public:
+            MappedObject(const MappedMachine * machine, uint32_t shape, MappedList values):
+                _machine(machine),
+                _shape(shape),
+                _values(values) {}
+
+            size_t size() const;
+            MappedKeys keys() const;
+            const MappedList & values() const;
+
+            // Position of the key, or -1
+            int find(std::string_view) const;
+
+            bool hasKey(const std::string &) const;
+
+            // Null for a missing key
+            Pointer at(const std::string &) const;
+    };
+
+    // Read-only Machine served from a snapshot file, mapped into
+    // memory rather than read. Opening checks the header, the
+    // section bounds, and every offset, span, shape id and value
+    // word against what it refers to, so that a damaged file is
+    // refused rather than read out of bounds. That is one pass over
+    // the tables; nothing is converted or copied.
+    //
+    // Same getters as a const Machine, returning views into the
+    // mapping. GetResultSet gives a
+    // Machine::ResultSet<const MappedMachine *>, which supports
+    // every read-only member function.
+    class MappedMachine {
+        friend class MappedKeys;
+        friend class MappedObject;
+
+        private:
+            const char * _data;
+            size_t _size;
+
+            // Set when the file was read rather than mapped
+            std::string _buffer;
+
+            const SnapshotHeader * _header;
+
+            MappedMachine();
+
+            template <typename T>
+            const T * Section(SnapshotHeader::Section) const;
+
+            std::string_view Span(
+                SnapshotHeader::Section spans,
+                SnapshotHeader::Section bytes,
+                size_t index
+            ) const;
+
+            std::string_view Key(uint32_t id) const;
+            bool Check() const;
+        public:
+            typedef Machine::ResultSet<const MappedMachine *>
+            result_set_t;
+
+            virtual ~MappedMachine();
+            MappedMachine(const MappedMachine &) = delete;
+            MappedMachine & operator=(const MappedMachine &) = delete;
+
+            // Null if the file cannot be opened or is not a snapshot
+            // of this version
+            static std::shared_ptr<const MappedMachine> Open(const std::string & path);
+
+            // Bytes of the mapping
+            size_t Size() const;
+
+            key_t StringCount() const;
+            key_t ListCount() const;
+            key_t ObjectCount() const;
+
+            MappedObject Object(key_t) const;
+            MappedList List(key_t) const;
+            std::string_view String(key_t) const;
+            int Integer(key_t) const;
+            float Float(key_t) const;
+            bool Boolean(key_t) const;
+            std::string_view SourceText(Pointer) const;
+
+            // Structural hash (see HashValue). Not cached, as the
+            // mapping is never written to.
+            uint64_t Hash(Pointer) const;
+
+            // Index of the field over the records of the list (see
+            // JsonIndex.h). Built on every call, for the same reason.
+            FieldIndex HashIndex(key_t list, const std::string & field) const;
+            FieldIndex OrderedIndex(key_t list, const std::string & field) const;
+
+            result_set_t GetResultSet() const;
+            result_set_t GetResultSet(key_t start) const;
+    };
+};
+
+#endif
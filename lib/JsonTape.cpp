@@ -0,0 +1,258 @@
+#include "JsonTape.h"
+#include <cstring>
+
+void
+Json::Tape::Push(Tag tag, uint64_t payload) {
+    _entries.push_back(((uint64_t)tag << TAG_SHIFT) | (payload & PAYLOAD_MASK));
+}
+
+size_t
+Json::Tape::Size() const {
+    return _entries.size();
+}
+
+bool
+Json::Tape::Empty() const {
+    return _entries.empty();
+}
+
+Json::Tape::Tag
+Json::Tape::TagAt(size_t index) const {
+    return (Tag)(_entries[index] >> TAG_SHIFT);
+}
+
+uint64_t
+Json::Tape::PayloadAt(size_t index) const {
+    return _entries[index] & PAYLOAD_MASK;
+}
+
+size_t
+Json::Tape::Match(size_t index) const {
+    return (size_t)PayloadAt(index);
+}
+
+std::string_view
+Json::Tape::String(size_t index) const {
+    size_t offset = (size_t)PayloadAt(index);
+    uint32_t length = 0;
+    std::memcpy(&length, _strings.data() + offset, sizeof length);
+
+    return std::string_view(
+        _strings.data() + offset + sizeof length,
+        length
+    );
+}
+
+Homonumeric
+Json::Tape::Numeric(size_t index) const {
+    uint32_t bits = (uint32_t)PayloadAt(index);
+
+    switch (TagAt(index)) {
+        case Tag::RAW:
+            {
+                auto text = String(index);
+                return Homonumeric::Raw(text.data(), (int)text.size());
+            }
+        case Tag::INTEGER:
+            {
+                int value = 0;
+                std::memcpy(&value, &bits, sizeof value);
+                return Homonumeric::Integer(value);
+            }
+        case Tag::FLOAT:
+            {
+                float value = 0;
+                std::memcpy(&value, &bits, sizeof value);
+                return Homonumeric::Float(value);
+            }
+        default:
+            return Homonumeric::Boolean((bool)bits);
+    }
+}
+
+const std::vector<uint64_t> &
+Json::Tape::Entries() const {
+    return _entries;
+}
+
+const std::string &
+Json::Tape::Strings() const {
+    return _strings;
+}
+
+void
+Json::Tape::Clear() {
+    _entries.clear();
+    _strings.clear();
+}
+
+size_t
+Json::Tape::Start(Tag tag) {
+    // Patched by Finish
+    Push(tag, 0);
+    return _entries.size() - 1;
+}
+
+void
+Json::Tape::Finish(size_t start, Tag tag) {
+    size_t end = _entries.size();
+    Push(tag, start);
+
+    _entries[start] = (_entries[start] & ~PAYLOAD_MASK)
+        | ((uint64_t)end & PAYLOAD_MASK);
+}
+
+void
+Json::Tape::Push(Tag tag, const char * text, size_t size) {
+    uint32_t length = (uint32_t)size;
+    Push(tag, _strings.size());
+    _strings.append((const char *)&length, sizeof length);
+    _strings.append(text, size);
+}
+
+void
+Json::Tape::Push(Tag tag, const std::string & value) {
+    Push(tag, value.data(), value.size());
+}
+
+void
+Json::Tape::Push(Homonumeric value) {
+    uint32_t bits = 0;
+
+    switch (value.Mode) {
+        case Homonumeric::Mode::INTEGER:
+            std::memcpy(&bits, &value.Payload.Integer, sizeof bits);
+            Push(Tag::INTEGER, bits);
+            break;
+        case Homonumeric::Mode::FLOAT:
+            std::memcpy(&bits, &value.Payload.Float, sizeof bits);
+            Push(Tag::FLOAT, bits);
+            break;
+        case Homonumeric::Mode::BOOLEAN:
+            Push(Tag::BOOLEAN, value.Payload.Boolean ? 1 : 0);
+            break;
+        case Homonumeric::Mode::RAW:
+            Push(Tag::RAW, value.Payload.Raw.Text, value.Payload.Raw.Length);
+            break;
+        default:
+            PushNull();
+            break;
+    }
+}
+
+void
+Json::Tape::PushNull() {
+    Push(Tag::NIL, 0);
+}
+
+std::shared_ptr<Json::Machine>
+Json::Tape::ToMachine() const {
+    auto machine = std::make_shared<Machine>();
+
+    // Open containers, innermost last
+    std::vector<Pointer> containers;
+    std::string key;
+
+    for (size_t i = 0; i < _entries.size(); ++i) {
+        Pointer value;
+
+        switch (TagAt(i)) {
+            case Tag::OBJECT_END:
+            case Tag::LIST_END:
+                containers.pop_back();
+                continue;
+            case Tag::KEY:
+                {
+                    auto payload = String(i);
+                    key.assign(payload.data(), payload.size());
+                }
+
+                continue;
+            case Tag::OBJECT_START:
+                value = machine->NewObject();
+                break;
+            case Tag::LIST_START:
+                value = machine->NewList();
+                break;
+            case Tag::STRING:
+                value = machine->NewString(std::string(String(i)));
+                break;
+            case Tag::INTEGER:
+                value = machine->NewInteger(Numeric(i).Payload.Integer);
+                break;
+            case Tag::FLOAT:
+                value = machine->NewFloat(Numeric(i).Payload.Float);
+                break;
+            case Tag::BOOLEAN:
+                value = machine->NewBoolean(Numeric(i).Payload.Boolean);
+                break;
+            case Tag::RAW:
+                value = machine->NewNumber(std::string(String(i)));
+                break;
+            default:
+                break;
+        }
+
+        if (!containers.empty()) {
+            Pointer parent = containers.back();
+
+            // A repeated key keeps its first value
+            if (parent.type == Type::OBJECT)
+                machine->Object(parent.key).add(key, value);
+            else
+                machine->List(parent.key).push_back(value);
+        }
+
+        if (value.type == Type::OBJECT || value.type == Type::LIST)
+            containers.push_back(value);
+    }
+
+    // Containers are created before their children, so the
+    // starting object comes first
+    if (!_entries.empty())
+        machine->SetStartingObject(0);
+
+    return machine;
+}
+
+void
+Json::TapeWriter::StartObject() {
+    _open.push_back(_tape.Start(Tape::Tag::OBJECT_START));
+}
+
+void
+Json::TapeWriter::Key(const std::string & key) {
+    _tape.Push(Tape::Tag::KEY, key);
+}
+
+void
+Json::TapeWriter::EndObject() {
+    _tape.Finish(_open.back(), Tape::Tag::OBJECT_END);
+    _open.pop_back();
+}
+
+void
+Json::TapeWriter::StartList() {
+    _open.push_back(_tape.Start(Tape::Tag::LIST_START));
+}
+
+void
+Json::TapeWriter::EndList() {
+    _tape.Finish(_open.back(), Tape::Tag::LIST_END);
+    _open.pop_back();
+}
+
+void
+Json::TapeWriter::String(const std::string & value) {
+    _tape.Push(Tape::Tag::STRING, value);
+}
+
+void
+Json::TapeWriter::Numeric(Homonumeric value) {
+    _tape.Push(value);
+}
+
+void
+Json::TapeWriter::Null() {
+    _tape.PushNull();
+}
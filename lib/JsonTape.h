@@ -0,0 +1,196 @@
+#pragma once
+#ifndef _JSONTAPE_H
+#define _JSONTAPE_H
+
+#include "Homonumeric.h"
+#include "JsonArena.h"
+#include "JsonMachine.h"
+#include <cstdint>
+#include <string_view>
+
+namespace Json {
+    // Flat form of a document: one array of 64-bit entries in
+    // document order, plus a side buffer for the bytes of every key
+    // and string.
+    //
+    // Each entry carries a tag in its top byte and a payload in the
+    // remaining 56 bits:
+    //
+    //   OBJECT_START, LIST_START   index of the matching end entry
+    //   OBJECT_END, LIST_END       index of the matching start entry
+    //   KEY, STRING                offset into the string buffer
+    //   INTEGER, FLOAT             the 32 bits of the value
+    //   RAW                        offset into the string buffer
+    //   BOOLEAN                    0 or 1
+    //   NIL                        0
+    //
+    // In the string buffer, every key, string or raw number is
+    // preceded by its length as a 32-bit integer.
+    class Tape {
+        public:
+            enum Tag {
+                OBJECT_START = '{',
+                OBJECT_END = '}',
+                LIST_START = '[',
+                LIST_END = ']',
+                KEY = 'k',
+                STRING = '"',
+                INTEGER = 'i',
+                FLOAT = 'f',
+                BOOLEAN = 'b',
+                RAW = 'r',
+                NIL = 'n'
+            };
+
+            static const int TAG_SHIFT = 56;
+            static const uint64_t PAYLOAD_MASK = (1ULL << TAG_SHIFT) - 1;
+        private:
+            std::vector<uint64_t>
+            _entries;
+
+            std::string
+            _strings;
+
+            void Push(Tag, uint64_t payload);
+            void Push(Tag, const char *, size_t);
+        public:
+            virtual ~Tape() = default;
+            Tape() = default;
+
+            size_t Size() const;
+            bool Empty() const;
+            Tag TagAt(size_t) const;
+            uint64_t PayloadAt(size_t) const;
+
+            // For a start entry, the index of its end entry, and
+            // the other way around
+            size_t Match(size_t) const;
+
+            // Key, string, or source text of a raw number
+            std::string_view String(size_t) const;
+
+            // A RAW Homonumeric points into the string buffer
+            Homonumeric Numeric(size_t) const;
+
+            const std::vector<uint64_t> & Entries() const;
+            const std::string & Strings() const;
+
+            // Keeps the capacity of both buffers
+            void Clear();
+
+            size_t Start(Tag);
+            void Finish(size_t start, Tag);
+            void Push(Tag, const std::string &);
+            void Push(Homonumeric);
+            void PushNull();
+
+            // Calls the visitor in the same order as a postorder
+            // walk of the equivalent Tree. Visitor_Type needs only
+            // the ITreeVisitor member functions. Null values visit
+            // as T().
+            template <typename T, typename Visitor_Type>
+            T Accept(Visitor_Type & visitor) const;
+
+            // Builds the Machine in one pass over the entries. Where
+            // an object repeats a key, the first value is kept and
+            // the later ones are left in the Machine unreferenced.
+            std::shared_ptr<Machine> ToMachine() const;
+    };
+
+    // Parser sink that writes the document to a tape
+    class TapeWriter {
+        private:
+            Tape & _tape;
+
+            std::vector<size_t>
+            _open;
+        public:
+            TapeWriter(Tape & tape):
+                _tape(tape) {}
+
+            void StartObject();
+            void Key(const std::string &);
+            void EndObject();
+            void StartList();
+            void EndList();
+            void String(const std::string &);
+            void Numeric(Homonumeric);
+            void Null();
+    };
+};
+
+template <typename T, typename V>
+T
+Json::Tape::Accept(V & visitor) const {
+    struct Frame {
+        size_t Base;
+        tree_keys_t Keys;
+    };
+
+    // Kept between containers of the same depth
+    std::vector<Frame> frames;
+    size_t depth = 0;
+
+    std::vector<T> values;
+    tree_string_t text;
+
+    for (size_t i = 0; i < _entries.size(); ++i) {
+        switch (TagAt(i)) {
+            case Tag::OBJECT_START:
+            case Tag::LIST_START:
+                if (depth == frames.size())
+                    frames.push_back(Frame());
+
+                frames[depth].Base = values.size();
+                frames[depth].Keys.clear();
+                ++depth;
+                break;
+            case Tag::OBJECT_END:
+            case Tag::LIST_END:
+                {
+                    auto & frame = frames[--depth];
+
+                    std::vector<T> children(
+                        std::make_move_iterator(values.begin() + frame.Base),
+                        std::make_move_iterator(values.end())
+                    );
+
+                    values.erase(values.begin() + frame.Base, values.end());
+
+                    values.push_back(TagAt(i) == Tag::OBJECT_END
+                        ? visitor.ForObject(frame.Keys, std::move(children))
+                        : visitor.ForList(std::move(children))
+                    );
+                }
+
+                break;
+            case Tag::KEY:
+                {
+                    auto key = String(i);
+                    frames[depth - 1].Keys.emplace_back(key.data(), key.size());
+                }
+
+                break;
+            case Tag::STRING:
+                {
+                    auto payload = String(i);
+                    text.assign(payload.data(), payload.size());
+                    values.push_back(visitor.ForString(text));
+                }
+
+                break;
+            case Tag::NIL:
+                values.push_back(T());
+                break;
+            default:
+                values.push_back(visitor.ForNumeric(Numeric(i)));
+                break;
+        }
+    }
+
+    return values.empty()
+        ? T()
+        : std::move(values.back());
+}
+
+#endif
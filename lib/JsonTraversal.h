@@ -0,0 +1,297 @@
+#pragma once
+#ifndef _JSONTRAVERSAL_H
+#define _JSONTRAVERSAL_H
+
+#include "JsonTree.h"
+
+namespace Json {
+    // Child values of a container, as handed to a postorder visitor.
+    // The range points into the value stack of a Traversal and is
+    // only valid for the duration of the call. Values may be moved
+    // out of it.
+    template <typename T>
+    class ValueRange {
+        private:
+            T * _begin;
+            size_t _size;
+        public:
+            ValueRange(T * begin, size_t size):
+                _begin(begin),
+                _size(size) {}
+
+            T * begin() const {
+                return _begin;
+            }
+
+            T * end() const {
+                return _begin + _size;
+            }
+
+            size_t size() const {
+                return _size;
+            }
+
+            T & operator[](size_t index) const {
+                return _begin[index];
+            }
+    };
+
+    // Postorder-traversal visitor for Traversal<T>
+    template <typename T>
+    class IPostorderVisitor {
+        public:
+            virtual ~IPostorderVisitor() = default;
+            virtual T ForString(const tree_string_t &) = 0;
+            virtual T ForNumeric(Homonumeric) = 0;
+            virtual T ForObject(const tree_keys_t &, ValueRange<T>) = 0;
+            virtual T ForList(ValueRange<T>) = 0;
+    };
+
+    // Preorder-traversal visitor for Traversal<T>. Key is called
+    // before each value of an object, including a null one.
+    class IPreorderVisitor {
+        public:
+            virtual ~IPreorderVisitor() = default;
+            virtual void StartObject() = 0;
+            virtual void Key(const tree_string_t &) = 0;
+            virtual void EndObject() = 0;
+            virtual void StartList() = 0;
+            virtual void EndList() = 0;
+            virtual void ForString(const tree_string_t &) = 0;
+            virtual void ForNumeric(Homonumeric) = 0;
+            virtual void Null() = 0;
+    };
+
+    // Walks a Tree with an explicit stack instead of recursion.
+    //
+    // The visitor is passed by reference. As with Json::Accept,
+    // Visitor_Type needs only the member functions of
+    // IPostorderVisitor or IPreorderVisitor, and a final class lets
+    // the compiler inline each call.
+    //
+    // Child values of every container are kept on one value stack.
+    // The stacks keep their capacity from one walk to the next, so
+    // a Traversal can be reused across trees.
+    template <typename T>
+    class Traversal {
+        private:
+            typedef std::unique_ptr<Tree<T>, TreeDeleter<Tree<T>>>
+            tree_t;
+
+            struct Frame {
+                const Tree<T> * Node;
+
+                // Next child to visit
+                size_t Next;
+
+                // Position in the value stack of the first child value
+                size_t Base;
+            };
+
+            std::vector<Frame>
+            _frames;
+
+            std::vector<T>
+            _values;
+
+            static const std::pmr::vector<tree_t> &
+            Children(const Tree<T> *);
+
+            // Visits a string, number or null subtree, pushing its
+            // value. Returns false for a container.
+            template <typename Visitor_Type>
+            bool PushLeaf(const Tree<T> *, Visitor_Type &);
+
+            // Visits a string, number or null subtree. Returns false
+            // for a container.
+            template <typename Visitor_Type>
+            static bool VisitLeaf(const Tree<T> *, Visitor_Type &);
+
+            template <typename Visitor_Type>
+            static void Start(const Tree<T> *, Visitor_Type &);
+
+            template <typename Visitor_Type>
+            static void End(const Tree<T> *, Visitor_Type &);
+        public:
+            virtual ~Traversal() = default;
+            Traversal() = default;
+
+            // A null subtree visits as T()
+            template <typename Visitor_Type>
+            T Postorder(const Tree<T> * tree, Visitor_Type & visitor);
+
+            // A null subtree visits as Null()
+            template <typename Visitor_Type>
+            void Preorder(const Tree<T> * tree, Visitor_Type & visitor);
+    };
+};
+
+template <typename T>
+const std::pmr::vector<typename Json::Traversal<T>::tree_t> &
+Json::Traversal<T>::Children(const Tree<T> * tree) {
+    return tree->GetKind() == Tree<T>::Kind::OBJECT
+        ? static_cast<const Object<T> *>(tree)->Values()
+        : static_cast<const List<T> *>(tree)->Values();
+}
+
+template <typename T>
+template <typename V>
+bool
+Json::Traversal<T>::PushLeaf(const Tree<T> * tree, V & visitor) {
+    if (!tree) {
+        _values.push_back(T());
+        return true;
+    }
+
+    switch (tree->GetKind()) {
+        case Tree<T>::Kind::STRING:
+            _values.push_back(visitor.ForString(
+                static_cast<const String<T> *>(tree)->Payload()
+            ));
+
+            return true;
+        case Tree<T>::Kind::NUMERIC:
+            _values.push_back(visitor.ForNumeric(
+                static_cast<const Numeric<T> *>(tree)->Payload()
+            ));
+
+            return true;
+        default:
+            return false;
+    }
+}
+
+template <typename T>
+template <typename V>
+bool
+Json::Traversal<T>::VisitLeaf(const Tree<T> * tree, V & visitor) {
+    if (!tree) {
+        visitor.Null();
+        return true;
+    }
+
+    switch (tree->GetKind()) {
+        case Tree<T>::Kind::STRING:
+            visitor.ForString(
+                static_cast<const String<T> *>(tree)->Payload()
+            );
+
+            return true;
+        case Tree<T>::Kind::NUMERIC:
+            visitor.ForNumeric(
+                static_cast<const Numeric<T> *>(tree)->Payload()
+            );
+
+            return true;
+        default:
+            return false;
+    }
+}
+
+template <typename T>
+template <typename V>
+void
+Json::Traversal<T>::Start(const Tree<T> * tree, V & visitor) {
+    if (tree->GetKind() == Tree<T>::Kind::OBJECT)
+        visitor.StartObject();
+    else
+        visitor.StartList();
+}
+
+template <typename T>
+template <typename V>
+void
+Json::Traversal<T>::End(const Tree<T> * tree, V & visitor) {
+    if (tree->GetKind() == Tree<T>::Kind::OBJECT)
+        visitor.EndObject();
+    else
+        visitor.EndList();
+}
+
+template <typename T>
+template <typename V>
+T
+Json::Traversal<T>::Postorder(const Tree<T> * tree, V & visitor) {
+    _frames.clear();
+    _values.clear();
+
+    if (!PushLeaf(tree, visitor))
+        _frames.push_back(Frame { tree, 0, 0 });
+
+    while (!_frames.empty()) {
+        Frame & frame = _frames.back();
+        auto & children = Children(frame.Node);
+
+        if (frame.Next < children.size()) {
+            const Tree<T> * child = children[frame.Next++].get();
+
+            // Invalidates frame
+            if (!PushLeaf(child, visitor))
+                _frames.push_back(Frame { child, 0, _values.size() });
+
+            continue;
+        }
+
+        ValueRange<T> range(
+            _values.data() + frame.Base,
+            _values.size() - frame.Base
+        );
+
+        T value = frame.Node->GetKind() == Tree<T>::Kind::OBJECT
+            ? visitor.ForObject(
+                static_cast<const Object<T> *>(frame.Node)->Keys(),
+                range
+            )
+            : visitor.ForList(range);
+
+        _values.erase(_values.begin() + frame.Base, _values.end());
+        _values.push_back(std::move(value));
+        _frames.pop_back();
+    }
+
+    T result = std::move(_values.back());
+    _values.clear();
+    return result;
+}
+
+template <typename T>
+template <typename V>
+void
+Json::Traversal<T>::Preorder(const Tree<T> * tree, V & visitor) {
+    _frames.clear();
+
+    if (VisitLeaf(tree, visitor))
+        return;
+
+    Start(tree, visitor);
+    _frames.push_back(Frame { tree, 0, 0 });
+
+    while (!_frames.empty()) {
+        Frame & frame = _frames.back();
+        auto & children = Children(frame.Node);
+
+        if (frame.Next < children.size()) {
+            size_t index = frame.Next++;
+            const Tree<T> * child = children[index].get();
+
+            if (frame.Node->GetKind() == Tree<T>::Kind::OBJECT)
+                visitor.Key(
+                    static_cast<const Object<T> *>(frame.Node)->Keys()[index]
+                );
+
+            if (!VisitLeaf(child, visitor)) {
+                Start(child, visitor);
+
+                // Invalidates frame
+                _frames.push_back(Frame { child, 0, 0 });
+            }
+
+            continue;
+        }
+
+        End(frame.Node, visitor);
+        _frames.pop_back();
+    }
+}
+
+#endif
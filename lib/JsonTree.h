@@ -3,6 +3,7 @@
 #define _JSONTREE_H
 
 #include "Homonumeric.h"
+#include "JsonArena.h"
 #include <memory>
 #include <string>
 #include <vector>
@@ -12,14 +13,20 @@ namespace Json {
     class Tree;
 
     // Postorder-traversal visitor
+    //
+    // Strings and keys are std::pmr types, which may live in an
+    // Arena. Implementations written against std::string and
+    // std::vector<std::string> need their signatures changed; a
+    // visitor that keeps a key or string past the call copies it,
+    // e.g. with std::string(text).
     template <typename T>
     class ITreeVisitor {
         public:
             virtual ~ITreeVisitor() = default;
-            virtual T ForString(const std::string &) = 0;
+            virtual T ForString(const tree_string_t &) = 0;
             virtual T ForNumeric(Homonumeric) = 0;
             virtual T ForObject(
-                const std::vector<std::string> &,
+                const tree_keys_t &,
                 std::vector<T> &&
             ) = 0;
             virtual T ForList(std::vector<T> &&) = 0;
@@ -27,71 +34,149 @@ namespace Json {
 
     template <typename T>
     class Tree {
+        public:
+            enum Kind {
+                OBJECT,
+                LIST,
+                STRING,
+                NUMERIC
+            };
+        private:
+            Kind _kind;
+            bool _in_arena;
+        protected:
+            Tree(Kind kind):
+                _kind(kind),
+                _in_arena(false) {}
         public:
             virtual ~Tree() = default;
             virtual T Accept(std::shared_ptr<ITreeVisitor<T>>) = 0;
+
+            Kind GetKind() const {
+                return _kind;
+            }
+
+            bool InArena() const {
+                return _in_arena;
+            }
+
+            // Called by a factory that placed the node in an Arena
+            void SetInArena() {
+                _in_arena = true;
+            }
     };
 
     #ifdef TREE_T
     #undef TREE_T
     #endif
-    #define TREE_T(T) std::unique_ptr<Json::Tree<T>>
+    #define TREE_T(T) std::unique_ptr<Json::Tree<T>, Json::TreeDeleter<Json::Tree<T>>>
 
     template <typename T>
     class Object: public Tree<T> {
         private:
-            std::vector<std::string> _keys;
-            std::vector<TREE_T(T)> _values;
+            tree_keys_t _keys;
+            std::pmr::vector<TREE_T(T)> _values;
         public:
             virtual ~Object() = default;
 
             Object(
-                std::vector<std::string> keys,
-                std::vector<TREE_T(T)> values
-            ):  _keys(std::move(keys)),
+                tree_keys_t keys,
+                std::pmr::vector<TREE_T(T)> values
+            ):  Tree<T>(Tree<T>::Kind::OBJECT),
+                _keys(std::move(keys)),
                 _values(std::move(values)) {}
 
             virtual T Accept(std::shared_ptr<ITreeVisitor<T>>) override;
+
+            const tree_keys_t & Keys() const {
+                return _keys;
+            }
+
+            const std::pmr::vector<TREE_T(T)> & Values() const {
+                return _values;
+            }
     };
 
     template <typename T>
     class List: public Tree<T> {
         private:
-            std::vector<TREE_T(T)> _values;
+            std::pmr::vector<TREE_T(T)> _values;
         public:
             virtual ~List() = default;
 
-            List(std::vector<TREE_T(T)> values):
+            List(std::pmr::vector<TREE_T(T)> values):
+                Tree<T>(Tree<T>::Kind::LIST),
                 _values(std::move(values)) {}
 
             virtual T Accept(std::shared_ptr<ITreeVisitor<T>>) override;
+
+            const std::pmr::vector<TREE_T(T)> & Values() const {
+                return _values;
+            }
     };
 
     template <typename T>
     class String: public Tree<T> {
         private:
-            std::string _payload;
+            tree_string_t _payload;
         public:
             virtual ~String() = default;
 
-            String(const std::string & payload):
-                _payload(payload) {}
+            String(
+                const std::string & payload,
+                std::pmr::memory_resource * resource
+                    = std::pmr::get_default_resource()
+            ):  Tree<T>(Tree<T>::Kind::STRING),
+                _payload(payload.data(), payload.size(), resource) {}
 
             virtual T Accept(std::shared_ptr<ITreeVisitor<T>>) override;
+
+            const tree_string_t & Payload() const {
+                return _payload;
+            }
     };
 
     template <typename T>
     class Numeric: public Tree<T> {
         private:
             Homonumeric _payload;
+
+            // Source text of a RAW payload, which points into it
+            tree_string_t _text;
         public:
             virtual ~Numeric() = default;
 
-            Numeric(Homonumeric payload):
-                _payload(payload) {}
+            Numeric(
+                Homonumeric payload,
+                std::pmr::memory_resource * resource
+                    = std::pmr::get_default_resource()
+            ):  Tree<T>(Tree<T>::Kind::NUMERIC),
+                _payload(payload),
+                _text(resource)
+            {
+                if (payload.Mode != Homonumeric::Mode::RAW)
+                    return;
+
+                _text.assign(payload.Payload.Raw.Text, payload.Payload.Raw.Length);
+                _payload.Payload.Raw.Text = _text.data();
+            }
+
+            Numeric(const Numeric &) = delete;
+            Numeric & operator=(const Numeric &) = delete;
 
             virtual T Accept(std::shared_ptr<ITreeVisitor<T>>) override;
+
+            Homonumeric Payload() const {
+                return _payload;
+            }
     };
+
+    // Statically dispatched counterpart of Tree<T>::Accept.
+    // Visitor_Type needs only the ITreeVisitor member functions;
+    // passing a final class lets the compiler inline each call.
+    // A null subtree visits as T().
+    template <typename T, typename Visitor_Type>
+    T Accept(const Tree<T> * tree, Visitor_Type & visitor);
 };
 
 template <typename T>
@@ -129,5 +214,49 @@ T Json::Numeric<T>::Accept(std::shared_ptr<ITreeVisitor<T>> visitor) {
     return visitor->ForNumeric(_payload);
 }
 
+template <typename T, typename V>
+T Json::Accept(const Json::Tree<T> * tree, V & visitor) {
+    if (!tree)
+        return T();
+
+    switch (tree->GetKind()) {
+        case Tree<T>::Kind::OBJECT:
+            {
+                auto & object = static_cast<const Object<T> &>(*tree);
+                std::vector<T> postvalues;
+                postvalues.reserve(object.Values().size());
+
+                for (auto & value : object.Values())
+                    postvalues.push_back(Accept(value.get(), visitor));
+
+                return visitor.ForObject(
+                    object.Keys(),
+                    std::move(postvalues)
+                );
+            }
+        case Tree<T>::Kind::LIST:
+            {
+                auto & list = static_cast<const List<T> &>(*tree);
+                std::vector<T> postvalues;
+                postvalues.reserve(list.Values().size());
+
+                for (auto & value : list.Values())
+                    postvalues.push_back(Accept(value.get(), visitor));
+
+                return visitor.ForList(std::move(postvalues));
+            }
+        case Tree<T>::Kind::STRING:
+            return visitor.ForString(
+                static_cast<const String<T> &>(*tree).Payload()
+            );
+        case Tree<T>::Kind::NUMERIC:
+            return visitor.ForNumeric(
+                static_cast<const Numeric<T> &>(*tree).Payload()
+            );
+    }
+
+    return T();
+}
+
 #undef TREE_T
 #endif
@@ -0,0 +1,191 @@
+#include "JsonVersions.h"
+
+Json::MachineVersion::MachineVersion(
+    std::shared_ptr<const Machine> base
+):  _base(base),
+    _start(base->GetResultSet()._pointer),
+    _number(0),
+    _strings(base->StringCount()),
+    _integers(base->IntegerCount()),
+    _floats(base->FloatCount()),
+    _booleans(base->BooleanCount())
+{
+    base->ConvertNumbers();
+}
+
+std::shared_ptr<Json::MachineVersion>
+Json::MachineVersion::Draft() const {
+    auto draft = std::make_shared<MachineVersion>(*this);
+    draft->_number = _number + 1;
+    draft->_strings.reset_copied();
+    draft->_integers.reset_copied();
+    draft->_floats.reset_copied();
+    draft->_booleans.reset_copied();
+    return draft;
+}
+
+uint64_t
+Json::MachineVersion::Number() const {
+    return _number;
+}
+
+const Json::Machine &
+Json::MachineVersion::Base() const {
+    return *_base;
+}
+
+size_t
+Json::MachineVersion::ChunksCopied() const {
+    return _strings.copied()
+        + _integers.copied()
+        + _floats.copied()
+        + _booleans.copied();
+}
+
+Json::key_t
+Json::MachineVersion::StringCount() const {
+    return _base->StringCount();
+}
+
+Json::key_t
+Json::MachineVersion::ListCount() const {
+    return _base->ListCount();
+}
+
+Json::key_t
+Json::MachineVersion::ObjectCount() const {
+    return _base->ObjectCount();
+}
+
+const Json::object_t &
+Json::MachineVersion::Object(key_t key) const {
+    return _base->Object(key);
+}
+
+const Json::list_t &
+Json::MachineVersion::List(key_t key) const {
+    return _base->List(key);
+}
+
+std::string_view
+Json::MachineVersion::String(key_t key) const {
+    if (auto value = _strings.find(key))
+        return *value;
+
+    return _base->String(key);
+}
+
+const int &
+Json::MachineVersion::Integer(key_t key) const {
+    if (auto value = _integers.find(key))
+        return *value;
+
+    return _base->Integer(key);
+}
+
+const float &
+Json::MachineVersion::Float(key_t key) const {
+    if (auto value = _floats.find(key))
+        return *value;
+
+    return _base->Float(key);
+}
+
+bool
+Json::MachineVersion::Boolean(key_t key) const {
+    if (auto value = _booleans.find(key))
+        return *value;
+
+    return _base->Boolean(key);
+}
+
+std::string_view
+Json::MachineVersion::SourceText(Pointer pointer) const {
+    switch (pointer.type) {
+        case Type::INTEGER:
+            if (_integers.changed(pointer.key))
+                return std::string_view();
+
+            break;
+        case Type::FLOAT:
+            if (_floats.changed(pointer.key))
+                return std::string_view();
+
+            break;
+        default:
+            break;
+    }
+
+    return _base->SourceText(pointer);
+}
+
+uint64_t
+Json::MachineVersion::Hash(Pointer value) const {
+    // Only the lists and objects under the value
+    std::unordered_map<uint64_t, uint64_t> hashes;
+
+    return HashValue(*this, value, [&](Pointer container) -> uint64_t & {
+        return hashes[((uint64_t)container.type << 32) | (uint32_t)container.key];
+    });
+}
+
+Json::FieldIndex
+Json::MachineVersion::HashIndex(key_t list, const std::string & field) const {
+    FieldIndex index;
+    IndexHashes(index, *this, list, field);
+    return index;
+}
+
+Json::FieldIndex
+Json::MachineVersion::OrderedIndex(key_t list, const std::string & field) const {
+    FieldIndex index;
+    IndexNumbers(index, *this, list, field);
+    return index;
+}
+
+std::string &
+Json::MachineVersion::String(key_t key) {
+    return _strings.write(key, [this](size_t index) {
+        return std::string(_base->String((key_t)index));
+    });
+}
+
+void
+Json::MachineVersion::SetInteger(key_t key, int value) {
+    _integers.write(key, [this](size_t index) {
+        return _base->Integer((key_t)index);
+    }) = value;
+}
+
+void
+Json::MachineVersion::SetFloat(key_t key, float value) {
+    _floats.write(key, [this](size_t index) {
+        return _base->Float((key_t)index);
+    }) = value;
+}
+
+void
+Json::MachineVersion::SetBoolean(key_t key, bool value) {
+    _booleans.write(key, [this](size_t index) {
+        return (char)_base->Boolean((key_t)index);
+    }) = value;
+}
+
+Json::MachineVersion::result_set_t
+Json::MachineVersion::GetResultSet() const {
+    return result_set_t(this, _start);
+}
+
+Json::MachineVersion::draft_result_set_t
+Json::MachineVersion::GetResultSet() {
+    return draft_result_set_t(this, _start);
+}
+
+Json::VersionedMachine::VersionedMachine(
+    std::shared_ptr<const Machine> base
+):  _current(std::make_shared<MachineVersion>(base)) {}
+
+std::shared_ptr<const Json::MachineVersion>
+Json::VersionedMachine::Current() const {
+    return std::atomic_load(&_current);
+}
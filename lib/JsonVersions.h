@@ -0,0 +1,226 @@
+#pragma once
+#ifndef _JSONVERSIONS_H
+#define _JSONVERSIONS_H
+
+#include "JsonMachine.h"
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+
+namespace Json {
+    // Values of one scalar pool of a version, in chunks of
+    // CHUNK_SIZE. A chunk is copied from the base Machine the first
+    // time a version writes to it, and copied again whenever a later
+    // version writes to a chunk it still shares with an earlier one.
+    template <typename T>
+    class VersionChunks {
+        public:
+            static const size_t CHUNK_BITS = 10;
+            static const size_t CHUNK_SIZE = (size_t)1 << CHUNK_BITS;
+            static const size_t CHUNK_MASK = CHUNK_SIZE - 1;
+
+            struct Chunk {
+                std::vector<T> Values;
+
+                // Set for each value written since the chunk was
+                // copied from the base
+                std::vector<bool> Changed;
+            };
+        private:
+            // Null for a chunk no version has written to
+            std::vector<std::shared_ptr<Chunk>>
+            _chunks;
+
+            size_t
+            _size;
+
+            size_t
+            _copied = 0;
+        public:
+            VersionChunks(size_t size = 0):
+                _chunks((size + CHUNK_SIZE - 1) >> CHUNK_BITS),
+                _size(size) {}
+
+            size_t
+            size() const {
+                return _size;
+            }
+
+            // Chunks copied since the last call to reset_copied
+            size_t
+            copied() const {
+                return _copied;
+            }
+
+            void
+            reset_copied() {
+                _copied = 0;
+            }
+
+            // Null while the value is the one in the base
+            const T *
+            find(size_t index) const {
+                auto & chunk = _chunks[index >> CHUNK_BITS];
+                return chunk ? &chunk->Values[index & CHUNK_MASK] : nullptr;
+            }
+
+            bool
+            changed(size_t index) const {
+                auto & chunk = _chunks[index >> CHUNK_BITS];
+                return chunk && chunk->Changed[index & CHUNK_MASK];
+            }
+
+            // Load_Type gives the value in the base by index. The
+            // caller must hold the only reference to this table.
+            template <typename Load_Type>
+            T &
+            write(size_t index, Load_Type && load) {
+                auto & chunk = _chunks[index >> CHUNK_BITS];
+
+                if (!chunk) {
+                    size_t first = index & ~CHUNK_MASK;
+                    size_t count = _size - first < CHUNK_SIZE ? _size - first : CHUNK_SIZE;
+                    chunk = std::make_shared<Chunk>();
+                    chunk->Values.reserve(count);
+
+                    for (size_t i = 0; i < count; ++i)
+                        chunk->Values.push_back(load(first + i));
+
+                    chunk->Changed.assign(count, false);
+                    ++_copied;
+                }
+                else if (chunk.use_count() > 1) {
+                    // Shared with a published version
+                    chunk = std::make_shared<Chunk>(*chunk);
+                    ++_copied;
+                }
+
+                chunk->Changed[index & CHUNK_MASK] = true;
+                return chunk->Values[index & CHUNK_MASK];
+            }
+    };
+
+    // Immutable view of a Machine at one point in its history. Lists
+    // and objects come from the base Machine, which every version
+    // shares; strings, integers, floats and booleans come from
+    // chunks where a version has changed them.
+    //
+    // GetResultSet gives a Machine::ResultSet<const MachineVersion *>,
+    // which supports every read-only member function. A draft, handed
+    // to VersionedMachine::Update, also supports ChangeString,
+    // ChangeInteger and ChangeFloat.
+    class MachineVersion {
+        friend class VersionedMachine;
+
+        private:
+            std::shared_ptr<const Machine> _base;
+            Pointer _start;
+            uint64_t _number;
+
+            VersionChunks<std::string> _strings;
+            VersionChunks<int> _integers;
+            VersionChunks<float> _floats;
+
+            // One byte per boolean, so that a chunk can hand out a
+            // reference
+            VersionChunks<char> _booleans;
+
+            // Next version, sharing every chunk with this one
+            std::shared_ptr<MachineVersion> Draft() const;
+        public:
+            typedef Machine::ResultSet<const MachineVersion *>
+            result_set_t;
+
+            typedef Machine::ResultSet<MachineVersion *>
+            draft_result_set_t;
+
+            virtual ~MachineVersion() = default;
+
+            // Version 0 of the Machine. Converts the text of every raw
+            // number, so that reading the base never writes to it.
+            MachineVersion(std::shared_ptr<const Machine>);
+
+            // Counts from 0 for the version made from the base
+            uint64_t Number() const;
+            const Machine & Base() const;
+
+            // Chunks the version copied from the one before it
+            size_t ChunksCopied() const;
+
+            key_t StringCount() const;
+            key_t ListCount() const;
+            key_t ObjectCount() const;
+
+            const object_t & Object(key_t) const;
+            const list_t & List(key_t) const;
+            std::string_view String(key_t) const;
+            const int & Integer(key_t) const;
+            const float & Float(key_t) const;
+            bool Boolean(key_t) const;
+
+            // Empty once the number has been changed
+            std::string_view SourceText(Pointer) const;
+
+            // Structural hash (see HashValue). Not cached: a draft can
+            // change any value under a list or object.
+            uint64_t Hash(Pointer) const;
+
+            // Index of the field over the records of the list (see
+            // JsonIndex.h). Built on every call, for the same reason.
+            FieldIndex HashIndex(key_t list, const std::string & field) const;
+            FieldIndex OrderedIndex(key_t list, const std::string & field) const;
+
+            // For a draft only
+            std::string & String(key_t);
+            void SetInteger(key_t, int);
+            void SetFloat(key_t, float);
+            void SetBoolean(key_t, bool);
+
+            result_set_t GetResultSet() const;
+            draft_result_set_t GetResultSet();
+    };
+
+    // Machine that readers query while a writer changes it, without
+    // either waiting for the other.
+    //
+    // A reader takes the current version with Current and keeps it
+    // for as long as it likes; the version never changes. Update hands
+    // a draft of the current version to the writer, copying only the
+    // chunks it writes to, then publishes the draft as the new
+    // current version. A version, and any chunk no later version
+    // shares, is freed when the last handle to it is dropped.
+    class VersionedMachine {
+        private:
+            std::shared_ptr<const MachineVersion> _current;
+
+            // Held by writers only
+            std::mutex _update;
+        public:
+            virtual ~VersionedMachine() = default;
+            VersionedMachine(std::shared_ptr<const Machine>);
+            VersionedMachine(const VersionedMachine &) = delete;
+            VersionedMachine & operator=(const VersionedMachine &) = delete;
+
+            std::shared_ptr<const MachineVersion> Current() const;
+
+            // Calls the update with a MachineVersion & to the draft.
+            // Writers wait for each other. Returns the new version.
+            template <typename Update_Type>
+            std::shared_ptr<const MachineVersion>
+            Update(Update_Type && update);
+    };
+};
+
+template <typename U>
+std::shared_ptr<const Json::MachineVersion>
+Json::VersionedMachine::Update(U && update) {
+    std::lock_guard<std::mutex> lock(_update);
+    auto draft = Current()->Draft();
+    update(*draft);
+
+    std::shared_ptr<const MachineVersion> version = draft;
+    std::atomic_store(&_current, version);
+    return version;
+}
+
+#endif
@@ -1,11 +1,18 @@
 #include "Lexer.h"
 
 Lexer::Lexer(std::shared_ptr<IEnumerator> && stream):
+    _max_length(0),
+    _length_exceeded(false),
+    _raw_numbers(false),
     _stream(std::move(stream))
 {
     NextChar();
 }
 
+void Lexer::Restart() {
+    NextChar();
+}
+
 bool Lexer::NextChar() {
     return _stream->Next(_current_char);
 }
@@ -116,9 +123,16 @@ int Lexer::LexString(char delimiter) {
     // 
     _string = "";
     _string += _current_char;
+    _length_exceeded = false;
+
+    while (NextChar() && _current_char != delimiter) {
+        if (_max_length && _string.size() >= (size_t)_max_length) {
+            _length_exceeded = true;
+            return Token::ERROR;
+        }
 
-    while (NextChar() && _current_char != delimiter)
         _string += _current_char;
+    }
 
     NextChar();
 
@@ -141,6 +155,7 @@ int Lexer::LexString(
     // 
     _string = "";
     _string += _current_char;
+    _length_exceeded = false;
     int token = (*forEachCharacter)(*this);
 
     while (_stream->HasNext() && _current_char != delimiter) {
@@ -149,6 +164,11 @@ int Lexer::LexString(
             case Token::ERROR:
                 return Token::ERROR;
             default:
+                if (_max_length && _string.size() >= (size_t)_max_length) {
+                    _length_exceeded = true;
+                    return Token::ERROR;
+                }
+
                 _string += (char)token;
                 break;
         }
@@ -225,6 +245,9 @@ int Lexer::LexNumber() {
     //         v
     //   -12.57
     // 
+    if (_raw_numbers)
+        return LexRawNumber();
+
     int wholePart;
     int token = LexInteger();
 
@@ -259,6 +282,60 @@ int Lexer::LexNumber() {
     return Token::FLOAT;
 }
 
+int Lexer::LexRawNumber() {
+    // Starting position:
+    //   v
+    //   12.57e-3
+    // 
+    // Ending position:
+    //           v
+    //   12.57e-3
+    // 
+    _string = "";
+    _string += _current_char;
+
+    while (NextChar() && isdigit(_current_char))
+        _string += _current_char;
+
+    if (_current_char == '.') {
+        _string += _current_char;
+
+        if (!NextChar() || !isdigit(_current_char))
+            return Token::ERROR;
+
+        _string += _current_char;
+
+        while (NextChar() && isdigit(_current_char))
+            _string += _current_char;
+    }
+
+    if (_current_char == 'e' || _current_char == 'E') {
+        _string += _current_char;
+
+        if (!NextChar())
+            return Token::ERROR;
+
+        if (_current_char == '+' || _current_char == '-') {
+            _string += _current_char;
+
+            if (!NextChar())
+                return Token::ERROR;
+        }
+
+        if (!isdigit(_current_char))
+            return Token::ERROR;
+
+        _string += _current_char;
+
+        while (NextChar() && isdigit(_current_char))
+            _string += _current_char;
+    }
+
+    return _stream->HasNext()
+        ? Token::NUMBER
+        : Token::END;
+}
+
 std::shared_ptr<IEnumerator> Lexer::Enumerator() {
     return _stream;
 }
@@ -285,6 +362,26 @@ int Lexer::Index() const {
     return _stream->Index();
 }
 
+void Lexer::SetMaxLength(int maxLength) {
+    _max_length = maxLength;
+}
+
+int Lexer::MaxLength() const {
+    return _max_length;
+}
+
+bool Lexer::LengthExceeded() const {
+    return _length_exceeded;
+}
+
+void Lexer::SetRawNumbers(bool rawNumbers) {
+    _raw_numbers = rawNumbers;
+}
+
+bool Lexer::RawNumbers() const {
+    return _raw_numbers;
+}
+
 bool Lexer::HasNext() const {
     return _stream->HasNext();
 }
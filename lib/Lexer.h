@@ -16,7 +16,8 @@ enum Token {
     FLOAT = -4,
     SPACE = -5,
     STRING = -6,
-    CHARACTER = -7
+    CHARACTER = -7,
+    NUMBER = -8
 };
 
 class Lexer {
@@ -26,6 +27,9 @@ class Lexer {
         float _float;
         char _character;
         char _current_char;
+        int _max_length;
+        bool _length_exceeded;
+        bool _raw_numbers;
         std::shared_ptr<IEnumerator> _stream;
     protected:
         std::shared_ptr<IEnumerator> Enumerator();
@@ -33,6 +37,10 @@ class Lexer {
         virtual ~Lexer() = default;
         Lexer(std::shared_ptr<IEnumerator> &&);
 
+        // Reads the first character again, for an enumerator that
+        // has been reset
+        void Restart();
+
         bool NextChar();
         bool IgnoreWhiteSpace();
         int LexWhiteSpace();
@@ -51,9 +59,24 @@ class Lexer {
             int (*forEachCharacter)(Lexer &)
         );
         int LexNumber();
+        int LexRawNumber();
 
         int NextToken();
         int Index() const;
+
+        // Zero leaves string length unchecked
+        void SetMaxLength(int);
+        int MaxLength() const;
+
+        // Whether the last string ended in an error because it ran
+        // past the maximum length
+        bool LengthExceeded() const;
+
+        // When set, LexNumber leaves numbers unconverted and returns
+        // NUMBER, with the source text in String()
+        void SetRawNumbers(bool);
+        bool RawNumbers() const;
+
         bool HasNext() const;
         char CurrentChar() const;
         const std::string & String() const;
@@ -3,6 +3,7 @@
 #define _VECTORBITSET_H
 
 #include <bitset>
+#include <climits>
 #include <string>
 #include <vector>
 
@@ -30,7 +31,14 @@ class vector_bitset {
         vector_bitset & operator=(const vector_bitset &) = default;
         vector_bitset();
         size_t size() const;
+        size_t capacity() const;
+        void reserve(size_t n);
+        void clear();
         vector_bitset & push_back(bool value = true);
+
+        // Copies whole words, shifted when this size is not a
+        // multiple of the word size
+        vector_bitset & append(const vector_bitset & other);
         bool at(size_t pos) const;
         vector_bitset & set(size_t pos, bool value = true);
         bool operator[](size_t pos) const;
@@ -58,6 +66,25 @@ vector_bitset<S>::size() const {
     return _size;
 }
 
+template <size_t S>
+size_t
+vector_bitset<S>::capacity() const {
+    return _list.capacity() * S;
+}
+
+template <size_t S>
+void
+vector_bitset<S>::reserve(size_t n) {
+    _list.reserve((n + S - 1) / S);
+}
+
+template <size_t S>
+void
+vector_bitset<S>::clear() {
+    _list.clear();
+    _size = 0;
+}
+
 template <size_t S>
 vector_bitset<S> &
 vector_bitset<S>::push_back(bool value) {
@@ -74,6 +101,29 @@ vector_bitset<S>::push_back(bool value) {
     return *this;
 }
 
+template <size_t S>
+vector_bitset<S> &
+vector_bitset<S>::append(const vector_bitset & other) {
+    size_t words = (other._size + S - 1) / S;
+    size_t shift = _size % S;
+
+    if (!shift)
+        _list.insert(_list.end(), other._list.begin(), other._list.begin() + words);
+    else {
+        _list.reserve((_size + other._size + S - 1) / S);
+
+        // Bits past the size of a word are never set
+        for (size_t i = 0; i < words; ++i) {
+            _list.back() |= other._list[i] << shift;
+            _list.push_back(other._list[i] >> (S - shift));
+        }
+    }
+
+    _size += other._size;
+    _list.resize((_size + S - 1) / S);
+    return *this;
+}
+
 template <size_t S>
 bool
 vector_bitset<S>::at(size_t pos) const {
@@ -1,4 +1,6 @@
 #include "MyJson.h"
+#include <cctype>
+#include <cstring>
 
 Json::MyLexer::MyLexer(
     std::shared_ptr<IEnumerator> && stream
@@ -13,6 +15,7 @@ int Json::MyLexer::NextToken() {
         case Token::STRING:
             token = "\"" + String() + '"';
             break;
+        case Token::NUMBER:
         case Token::WORD:
             token = String();
             break;
@@ -60,8 +63,8 @@ Json::MyLexer::Tokens() const {
 
 JSON_FACTORY_PTR
 Json::MyTreeFactory::NewObject(
-    std::vector<std::string> keys,
-    std::vector<ptr_t> values
+    tree_keys_t keys,
+    std::pmr::vector<ptr_t> values
 ) {
     return std::make_unique<Object<JSON_TREE_PARAMETER>>(
         std::move(keys),
@@ -71,7 +74,7 @@ Json::MyTreeFactory::NewObject(
 
 JSON_FACTORY_PTR
 Json::MyTreeFactory::NewList(
-    std::vector<ptr_t> values
+    std::pmr::vector<ptr_t> values
 ) {
     return std::make_unique<List<JSON_TREE_PARAMETER>>(
         std::move(values)
@@ -92,27 +95,93 @@ Json::MyTreeFactory::NewNumeric(
     return std::make_unique<Numeric<JSON_TREE_PARAMETER>>(value);
 }
 
+#ifdef JSON_ARENA_NEW
+#undef JSON_ARENA_NEW
+#endif
+#define JSON_ARENA_NEW(NODE, ...) \
+    auto node = _arena->New<NODE<JSON_TREE_PARAMETER>>(__VA_ARGS__); \
+    node->SetInArena(); \
+    return ptr_t(node);
+
+JSON_FACTORY_PTR
+Json::MyArenaTreeFactory::NewObject(
+    tree_keys_t keys,
+    std::pmr::vector<ptr_t> values
+) {
+    JSON_ARENA_NEW(Object, std::move(keys), std::move(values))
+}
+
+JSON_FACTORY_PTR
+Json::MyArenaTreeFactory::NewList(
+    std::pmr::vector<ptr_t> values
+) {
+    JSON_ARENA_NEW(List, std::move(values))
+}
+
+JSON_FACTORY_PTR
+Json::MyArenaTreeFactory::NewString(
+    const std::string & value
+) {
+    JSON_ARENA_NEW(String, value, _arena->Resource())
+}
+
+JSON_FACTORY_PTR
+Json::MyArenaTreeFactory::NewNumeric(
+    Homonumeric value
+) {
+    JSON_ARENA_NEW(Numeric, value, _arena->Resource())
+}
+
+#undef JSON_ARENA_NEW
+
+std::pmr::memory_resource *
+Json::MyArenaTreeFactory::Resource() {
+    return _arena->Resource();
+}
+
 JSON_TREE_PARAMETER
 Json::MyPostorderTreeVisitor::ForObject(
-    const std::vector<std::string> & keys,
+    const tree_keys_t & keys,
+    std::vector<JSON_TREE_PARAMETER> && values
+) {
+    return ForObject(
+        keys,
+        ValueRange<JSON_TREE_PARAMETER>(values.data(), values.size())
+    );
+}
+
+JSON_TREE_PARAMETER
+Json::MyPostorderTreeVisitor::ForList(
     std::vector<JSON_TREE_PARAMETER> && values
+) {
+    return ForList(
+        ValueRange<JSON_TREE_PARAMETER>(values.data(), values.size())
+    );
+}
+
+JSON_TREE_PARAMETER
+Json::MyPostorderTreeVisitor::ForObject(
+    const tree_keys_t & keys,
+    ValueRange<JSON_TREE_PARAMETER> values
 ) {
     auto objectPtr = _machine->NewObject();
     auto & object = _machine->Object(objectPtr.key);
+    object.reserve(keys.size());
 
-    for (int i = 0; i < keys.size(); ++i)
+    for (size_t i = 0; i < keys.size(); ++i)
         // TODO: Add collision checking
-        object.add(keys[i], values[i]);
+        object.add(std::string(keys[i].data(), keys[i].size()), values[i]);
 
     return objectPtr;
 }
 
 JSON_TREE_PARAMETER
 Json::MyPostorderTreeVisitor::ForList(
-    std::vector<JSON_TREE_PARAMETER> && values
+    ValueRange<JSON_TREE_PARAMETER> values
 ) {
     auto listPtr = _machine->NewList();
     auto & list = _machine->List(listPtr.key);
+    list.reserve(values.size());
 
     for (auto & value : values)
         list.push_back(value);
@@ -131,6 +200,10 @@ Json::MyPostorderTreeVisitor::ForNumeric(
             return _machine->NewInteger(value.Payload.Integer);
         case Homonumeric::Mode::FLOAT:
             return _machine->NewFloat(value.Payload.Float);
+        case Homonumeric::Mode::RAW:
+            return _machine->NewNumber(
+                std::string(value.Payload.Raw.Text, value.Payload.Raw.Length)
+            );
         default:
             // TODO: Consider adding exception-handling here
             break;
@@ -141,9 +214,28 @@ Json::MyPostorderTreeVisitor::ForNumeric(
 
 JSON_TREE_PARAMETER
 Json::MyPostorderTreeVisitor::ForString(
-    const std::string & value
+    const tree_string_t & value
+) {
+    return _machine->NewString(std::string(value.data(), value.size()));
+}
+
+Json::MyPostorderTreeVisitor
+Json::MyPostorderTreeVisitor::Fork() const {
+    auto machine = std::make_shared<Machine>();
+    machine->SetInterning(_machine->Interning());
+    return MyPostorderTreeVisitor(machine);
+}
+
+void
+Json::MyPostorderTreeVisitor::Join(
+    MyPostorderTreeVisitor & forked,
+    ValueRange<JSON_TREE_PARAMETER> values
 ) {
-    return _machine->NewString(value);
+    auto offsets = _machine->Append(*forked._machine);
+    forked._machine = std::make_shared<Machine>();
+
+    for (auto & value : values)
+        value = offsets.Rebase(value);
 }
 
 std::shared_ptr<const Json::Machine>
@@ -160,12 +252,19 @@ Json::GetMutableMachine(std::istream & inputStream) {
     // auto lexer = std::make_shared<Json::Lexer>(enumerator);
     auto lexer = std::make_shared<Json::MyLexer>(enumerator);
     auto machine = std::make_shared<Json::Machine>();
-    auto visitor = std::make_shared<Json::MyPostorderTreeVisitor>(machine);
-    auto parse = Json::Parser<Json::Tree<Json::Pointer>>::Tree<Json::MyTreeFactory>(lexer);
+    Json::MyPostorderTreeVisitor visitor(machine);
+
+    // Outlives the tree
+    auto arena = std::make_shared<Json::Arena>();
+
+    auto parse = Json::Parser<Json::Tree<Json::Pointer>, Json::MyArenaTreeFactory>::Tree(
+        std::make_unique<Json::MyArenaTreeFactory>(arena),
+        lexer
+    );
     // auto parse = Json::Parser<Json::Tree<Json::Pointer>>::Tree<Json::MyTreeFactory>();
 
     if (parse.Success)
-        parse.Tree->Accept(visitor);
+        Json::Traversal<Json::Pointer>().Postorder(parse.Tree.get(), visitor);
 
     return machine;
 }
@@ -233,34 +332,404 @@ Json::ParserMessageToStream(
         ;
 }
 
+namespace Json { namespace {
+    MyResultSet
+    RunMyParser(
+        std::shared_ptr<IEnumerator> && enumerator,
+        const ParseOptions & options,
+        const PoolSizes & sizes
+    ) {
+        auto lexer = std::make_shared<Json::MyLexer>(std::move(enumerator));
+        auto machine = std::make_shared<Json::Machine>();
+        machine->SetInterning(options.InternStrings);
+        machine->Reserve(sizes);
+        Json::MyPostorderTreeVisitor visitor(machine);
+
+        // Outlives the tree
+        auto arena = std::make_shared<Json::Arena>();
+
+        Json::Parser<Json::Tree<Json::Pointer>, Json::MyArenaTreeFactory> parser(
+            std::make_unique<Json::MyArenaTreeFactory>(arena),
+            lexer
+        );
+
+        lexer->SetRawNumbers(options.RawNumbers);
+        parser.Select(options.Selection);
+        parser.SetLimits(options.Limits);
+        auto parse = parser.GetTree();
+
+        MyResultSet result;
+        result.Success = parse.Success;
+        result.Message = "";
+        result.Machine = nullptr;
+
+        if (!parse.Success) {
+            result.Message
+                = ParserMessageToString(*lexer, parse.Message);
+
+            return result;
+        }
+
+        Json::Traversal<Json::Pointer>().Postorder(parse.Tree.get(), visitor);
+        result.Machine = machine;
+        return result;
+    }
+} }
+
+Json::MyResultSet
+Json::RunMyParser(
+    std::istream & inputStream,
+    const ParseOptions & options
+) {
+    return RunMyParser(
+        std::make_shared<StreamEnumerator>(inputStream),
+        options,
+        PoolSizes()
+    );
+}
+
+Json::MyResultSet
+Json::RunMyParser(
+    const char * buffer,
+    size_t size,
+    const ParseOptions & options
+) {
+    PoolSizes sizes;
+
+    // A count of the whole document would over-reserve for a
+    // selection of it
+    if (options.PreCount && !options.Selection)
+        CountValues(buffer, size, sizes);
+
+    return RunMyParser(
+        std::make_shared<BufferEnumerator>(buffer, size),
+        options,
+        sizes
+    );
+}
+
 Json::MyResultSet
 Json::RunMyParser(
     std::istream & inputStream
 ) {
-    auto enumerator = std::make_shared<StreamEnumerator>(inputStream);
-    auto lexer = std::make_shared<Json::MyLexer>(enumerator);
-    auto machine = std::make_shared<Json::Machine>();
-    auto visitor = std::make_shared<Json::MyPostorderTreeVisitor>(machine);
-    auto parse = Json::Parser<Json::Tree<Json::Pointer>>::Tree<Json::MyTreeFactory>(lexer);
+    return RunMyParser(inputStream, ParseOptions());
+}
 
-    MyResultSet result;
+Json::MyResultSet
+Json::RunMyParser(
+    std::istream & inputStream,
+    const Projection & projection
+) {
+    ParseOptions options;
+    options.Selection = &projection;
+    return RunMyParser(inputStream, options);
+}
+
+Json::MyResultSet
+Json::RunMyParser(
+    std::istream & inputStream,
+    const Limits & limits
+) {
+    ParseOptions options;
+    options.Limits = limits;
+    return RunMyParser(inputStream, options);
+}
+
+namespace Json { namespace {
+    ValidationResult
+    Validate(
+        std::shared_ptr<IEnumerator> && enumerator,
+        const Limits & limits
+    ) {
+        auto validation = Json::Parser<Json::Tree<Json::Pointer>>::Validate(
+            std::make_shared<Json::Lexer>(std::move(enumerator)),
+            limits
+        );
+
+        return ValidationResult {
+            validation.Success,
+            validation.Code,
+            validation.Offset
+        };
+    }
+} }
 
+Json::ValidationResult
+Json::Validate(
+    std::istream & inputStream,
+    const Limits & limits
+) {
+    return Validate(
+        std::make_shared<StreamEnumerator>(inputStream),
+        limits
+    );
+}
+
+Json::ValidationResult
+Json::Validate(
+    const char * buffer,
+    size_t size,
+    const Limits & limits
+) {
+    return Validate(
+        std::make_shared<BufferEnumerator>(buffer, size),
+        limits
+    );
+}
+
+namespace {
+    // Whether a quote follows an odd run of backslashes
+    bool
+    Escaped(const char * begin, const char * quote) {
+        const char * slash = quote;
+
+        while (slash > begin && slash[-1] == '\\')
+            --slash;
+
+        return (quote - slash) % 2;
+    }
+}
+
+void
+Json::CountValues(
+    const char * buffer,
+    size_t size,
+    PoolSizes & sizes
+) {
+    const char * end = buffer + size;
+    const char * next = buffer;
+
+    while (next < end) {
+        switch (*next) {
+            case '{':
+                ++sizes.Objects;
+                ++next;
+                break;
+            case '[':
+                ++sizes.Lists;
+                ++next;
+                break;
+            case '"':
+                // Skips to the closing quote, past any escaped one
+                do {
+                    next = (const char *)std::memchr(next + 1, '"', end - next - 1);
+
+                    if (!next)
+                        return;
+                }
+                while (Escaped(buffer, next));
+
+                ++next;
+
+                while (next < end && std::isspace((unsigned char)*next))
+                    ++next;
+
+                // A key is followed by ':'
+                if (next == end || *next != ':')
+                    ++sizes.Strings;
+
+                break;
+            case 't':
+            case 'f':
+                ++sizes.Booleans;
+                [[fallthrough]];
+            case 'n':
+                while (next < end && std::isalpha((unsigned char)*next))
+                    ++next;
+
+                break;
+            case '-':
+            case '0': case '1': case '2': case '3': case '4':
+            case '5': case '6': case '7': case '8': case '9':
+                {
+                    bool integral = true;
+
+                    while (next < end && std::strchr("0123456789+-.eE", *next)) {
+                        if (*next == '.' || *next == 'e' || *next == 'E')
+                            integral = false;
+
+                        ++next;
+                    }
+
+                    if (integral)
+                        ++sizes.Integers;
+                    else
+                        ++sizes.Floats;
+                }
+
+                break;
+            default:
+                ++next;
+                break;
+        }
+    }
+}
+
+void
+Json::MachineWriter::Reset(Machine & machine) {
+    _machine = &machine;
+    _open.clear();
+}
+
+void
+Json::MachineWriter::Add(Pointer value) {
+    if (_open.empty())
+        return;
+
+    Pointer parent = _open.back();
+
+    // A repeated key keeps its first value
+    if (parent.type == Type::OBJECT)
+        _machine->Object(parent.key).add(_key, value);
+    else
+        _machine->List(parent.key).push_back(value);
+}
+
+void
+Json::MachineWriter::StartObject() {
+    Pointer object = _machine->NewObject();
+    Add(object);
+    _open.push_back(object);
+}
+
+void
+Json::MachineWriter::Key(const std::string & key) {
+    _key = key;
+}
+
+void
+Json::MachineWriter::EndObject() {
+    _open.pop_back();
+}
+
+void
+Json::MachineWriter::StartList() {
+    Pointer list = _machine->NewList();
+    Add(list);
+    _open.push_back(list);
+}
+
+void
+Json::MachineWriter::EndList() {
+    _open.pop_back();
+}
+
+void
+Json::MachineWriter::String(const std::string & value) {
+    Add(_machine->NewString(value));
+}
+
+void
+Json::MachineWriter::Numeric(Homonumeric value) {
+    switch (value.Mode) {
+        case Homonumeric::Mode::BOOLEAN:
+            Add(_machine->NewBoolean(value.Payload.Boolean));
+            break;
+        case Homonumeric::Mode::INTEGER:
+            Add(_machine->NewInteger(value.Payload.Integer));
+            break;
+        case Homonumeric::Mode::FLOAT:
+            Add(_machine->NewFloat(value.Payload.Float));
+            break;
+        case Homonumeric::Mode::RAW:
+            Add(_machine->NewNumber(
+                std::string(value.Payload.Raw.Text, value.Payload.Raw.Length)
+            ));
+            break;
+        default:
+            Null();
+            break;
+    }
+}
+
+void
+Json::MachineWriter::Null() {
+    Add(Pointer());
+}
+
+Json::ParseSession::ParseSession(
+    const ParseOptions & options
+):  _options(options),
+    _enumerator(std::make_shared<BufferEnumerator>(nullptr, 0)),
+    _lexer(std::make_shared<Json::Lexer>(_enumerator)),
+    // The grammar never reaches the factory
+    _parser(nullptr, _lexer),
+    _machine(std::make_shared<Machine>()),
+    _writer(*_machine)
+{
+    _lexer->SetRawNumbers(options.RawNumbers);
+    _parser.SetLimits(options.Limits);
+    _machine->SetInterning(options.InternStrings);
+}
+
+Json::MyResultSet
+Json::ParseSession::Parse(
+    const char * buffer,
+    size_t size
+) {
+    if (_machine.use_count() > 1) {
+        _machine = std::make_shared<Machine>();
+        _machine->SetInterning(_options.InternStrings);
+    }
+    else
+        _machine->Clear();
+
+    _enumerator->Reset(buffer, size);
+    _lexer->Restart();
+    _parser.Reset();
+    _writer.Reset(*_machine);
+
+    auto parse = _parser.Scan(_writer);
+
+    MyResultSet result;
     result.Success = parse.Success;
-    result.Message = "";
     result.Machine = nullptr;
 
     if (!parse.Success) {
-        result.Message
-            = ParserMessageToString(*lexer, parse.Message);
-
+        result.Message = parse.Message;
         return result;
     }
 
-    parse.Tree->Accept(visitor);
-    result.Machine = machine;
+    _machine->SetStartingObject(0);
+    result.Machine = _machine;
     return result;
 }
 
+Json::MyResultSet
+Json::ParseSession::Parse(
+    const std::string & document
+) {
+    return Parse(document.data(), document.size());
+}
+
+Json::ValidationResult
+Json::ParseTape(
+    std::istream & inputStream,
+    Tape & tape,
+    const Limits & limits
+) {
+    // The grammar never reaches the factory
+    Json::Parser<Json::Tree<Json::Pointer>> parser(
+        nullptr,
+        std::make_shared<Json::Lexer>(
+            std::make_shared<StreamEnumerator>(inputStream)
+        )
+    );
+
+    tape.Clear();
+    parser.SetLimits(limits);
+    auto parse = parser.Scan(TapeWriter(tape));
+
+    if (!parse.Success)
+        tape.Clear();
+
+    return ValidationResult {
+        parse.Success,
+        parse.Code,
+        parse.Offset
+    };
+}
+
 std::string
 Json::ParserMessageToString(
     const MyLexer & lexer,
@@ -2,11 +2,19 @@
 #ifndef _MYJSON_H
 #define _MYJSON_H
 
+#include "../lib/BufferEnumerator.h"
 #include "../lib/StreamEnumerator.h"
 #include "../lib/Lexer.h"
 #include "../lib/JsonParser.h"
 #include "../lib/JsonTree.h"
+#include "../lib/JsonTraversal.h"
+#include "../lib/JsonParallel.h"
+#include "../lib/JsonTape.h"
+#include "../lib/JsonSnapshot.h"
+#include "../lib/JsonVersions.h"
+#include "../lib/JsonFrozen.h"
 #include "../lib/JsonMachine.h"
+#include "../lib/JsonPatch.h"
 #include "../lib/JsonBuilder.h"
 #include <iomanip>
 
@@ -27,21 +35,50 @@ namespace Json {
             const std::vector<std::string> & Tokens() const;
     };
 
-    class MyTreeFactory: public ITreeFactory<Tree<Pointer>> {
+    // Final, so that Parser<Tree<Pointer>, MyTreeFactory> and
+    // Json::Accept can call it without virtual dispatch. Both
+    // classes still implement the virtual interfaces.
+    class MyTreeFactory final: public ITreeFactory<Tree<Pointer>> {
         public:
             virtual ~MyTreeFactory() = default;
 
             virtual ptr_t NewObject(
-                std::vector<std::string> keys,
-                std::vector<ptr_t> values
+                tree_keys_t keys,
+                std::pmr::vector<ptr_t> values
             ) override;
 
-            virtual ptr_t NewList(std::vector<ptr_t>) override;
+            virtual ptr_t NewList(std::pmr::vector<ptr_t>) override;
             virtual ptr_t NewString(const std::string &) override;
             virtual ptr_t NewNumeric(Homonumeric) override;
     };
 
-    class MyPostorderTreeVisitor: public ITreeVisitor<Pointer> {
+    // Places every node, with its keys and child arrays, in the
+    // arena. The tree must be destroyed before the arena is.
+    class MyArenaTreeFactory final: public ITreeFactory<Tree<Pointer>> {
+        private:
+            std::shared_ptr<Arena> _arena;
+        public:
+            MyArenaTreeFactory(
+                std::shared_ptr<Arena> arena
+            ):  _arena(arena) {}
+
+            virtual ~MyArenaTreeFactory() = default;
+
+            virtual ptr_t NewObject(
+                tree_keys_t keys,
+                std::pmr::vector<ptr_t> values
+            ) override;
+
+            virtual ptr_t NewList(std::pmr::vector<ptr_t>) override;
+            virtual ptr_t NewString(const std::string &) override;
+            virtual ptr_t NewNumeric(Homonumeric) override;
+            virtual std::pmr::memory_resource * Resource() override;
+    };
+
+    class MyPostorderTreeVisitor final:
+        public ITreeVisitor<Pointer>,
+        public IPostorderVisitor<Pointer>
+    {
         private:
             std::shared_ptr<Machine> _machine;
         public:
@@ -50,13 +87,24 @@ namespace Json {
             ):  _machine(machine) {}
 
             virtual ~MyPostorderTreeVisitor() = default;
-            virtual Pointer ForString(const std::string &) override;
+            virtual Pointer ForString(const tree_string_t &) override;
             virtual Pointer ForNumeric(Homonumeric) override;
             virtual Pointer ForObject(
-                const std::vector<std::string> &,
+                const tree_keys_t &,
                 std::vector<Pointer> &&
             ) override;
             virtual Pointer ForList(std::vector<Pointer> &&) override;
+
+            virtual Pointer ForObject(
+                const tree_keys_t &,
+                ValueRange<Pointer>
+            ) override;
+            virtual Pointer ForList(ValueRange<Pointer>) override;
+
+            // For Json::ParallelPostorder. A forked visitor builds
+            // into a new Machine, which Join appends to this one.
+            MyPostorderTreeVisitor Fork() const;
+            void Join(MyPostorderTreeVisitor &, ValueRange<Pointer>);
     };
 
     std::shared_ptr<const Machine>
@@ -88,6 +136,175 @@ namespace Json {
     RunMyParser(
         std::istream & inputStream
     );
+
+    // Materializes only the branches named in the projection
+    MyResultSet
+    RunMyParser(
+        std::istream & inputStream,
+        const Projection & projection
+    );
+
+    // Fails fast once the input exceeds one of the limits
+    MyResultSet
+    RunMyParser(
+        std::istream & inputStream,
+        const Limits & limits
+    );
+
+    struct ParseOptions {
+        // Materializes only the branches named here, if not null.
+        // Must outlive the parse.
+        const Json::Projection * Selection = nullptr;
+
+        Json::Limits Limits = Json::Limits();
+
+        // Keeps the text of every number, converting it on first
+        // read (see Machine::NewNumber)
+        bool RawNumbers = false;
+
+        // Shares the bytes of equal string values (see
+        // Machine::SetInterning)
+        bool InternStrings = false;
+
+        // Buffers only. Counts the values of each kind in a first
+        // pass (see CountValues), so that each pool of the Machine is
+        // allocated once. The pass skips the lexer and grammar, but
+        // still reads every byte once more, so it pays off only where
+        // the pools would otherwise grow many times. Ignored with a
+        // Selection, since the count cannot leave values out.
+        bool PreCount = false;
+    };
+
+    MyResultSet
+    RunMyParser(
+        std::istream & inputStream,
+        const ParseOptions & options
+    );
+
+    MyResultSet
+    RunMyParser(
+        const char * buffer,
+        size_t size,
+        const ParseOptions & options = ParseOptions()
+    );
+
+    struct ValidationResult {
+        bool Success;
+        ErrorCode Code;
+
+        // Index into the input at which the error was found
+        int Offset;
+    };
+
+    // Checks that the input is well-formed without building a
+    // Tree or a Machine
+    ValidationResult
+    Validate(
+        std::istream & inputStream,
+        const Limits & limits = Limits()
+    );
+
+    ValidationResult
+    Validate(
+        const char * buffer,
+        size_t size,
+        const Limits & limits = Limits()
+    );
+
+    // Counts the values of each kind, the way a Machine would store
+    // them, with one pass over the bytes for brackets, quotes and
+    // literals. Does not check the input; counts of malformed input
+    // are meaningless.
+    void
+    CountValues(
+        const char * buffer,
+        size_t size,
+        PoolSizes & sizes
+    );
+
+    // Parser sink that builds the document into a Machine in one
+    // pass, making each container before its children. The starting
+    // object is object 0. Where an object repeats a key, the first
+    // value is kept and the later ones are left in the Machine
+    // unreferenced.
+    class MachineWriter {
+        private:
+            Machine * _machine;
+
+            // Open containers, innermost last
+            std::vector<Pointer>
+            _open;
+
+            std::string
+            _key;
+
+            void Add(Pointer);
+        public:
+            MachineWriter(Machine & machine):
+                _machine(&machine) {}
+
+            // Writes the next document to the given Machine, keeping
+            // the capacity of the container stack
+            void Reset(Machine &);
+
+            void StartObject();
+            void Key(const std::string &);
+            void EndObject();
+            void StartList();
+            void EndList();
+            void String(const std::string &);
+            void Numeric(Homonumeric);
+            void Null();
+    };
+
+    // Parses one document after another with the same enumerator,
+    // lexer, parser and Machine. Each Parse clears the Machine of the
+    // last one and keeps the capacity of everything, so a stream of
+    // small documents of similar layout allocates next to nothing
+    // once the first few have been parsed.
+    //
+    // Builds with a MachineWriter rather than through a Tree, so the
+    // Selection and PreCount options are not used.
+    class ParseSession {
+        private:
+            ParseOptions _options;
+
+            std::shared_ptr<BufferEnumerator>
+            _enumerator;
+
+            std::shared_ptr<Lexer>
+            _lexer;
+
+            Parser<Tree<Pointer>>
+            _parser;
+
+            std::shared_ptr<Machine>
+            _machine;
+
+            MachineWriter
+            _writer;
+        public:
+            virtual ~ParseSession() = default;
+            ParseSession(const ParseOptions & options = ParseOptions());
+            ParseSession(const ParseSession &) = delete;
+            ParseSession & operator=(const ParseSession &) = delete;
+
+            // The Machine of the result belongs to the session. If it
+            // is still held at the next Parse, the session moves on to
+            // a new Machine rather than clearing it. On failure, the
+            // message has no token history.
+            MyResultSet Parse(const char * buffer, size_t size);
+            MyResultSet Parse(const std::string &);
+    };
+
+    // Parses the input straight into a tape, without building a
+    // Tree. On failure, the tape is left empty.
+    ValidationResult
+    ParseTape(
+        std::istream & inputStream,
+        Tape & tape,
+        const Limits & limits = Limits()
+    );
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,1074 @@
+#include "Benchmarks.h"
+
+void Benchmarks::Init() {
+    if (!Tests::WorkingDirectory.compare(""))
+        std::cout
+            << "Benchmarks: WARNING: The working directory has not been set.\n";
+
+    _list = {
+        {
+            "JsonParser_StaticDispatch_Versus_VirtualDispatch",
+            [](std::ostream & out) {
+                const int COPIES = 200;
+                std::string document = LargeDocument(COPIES);
+
+                auto virtualParse = [&]() {
+                    std::stringstream in(document);
+                    auto lexer = std::make_shared<Json::Lexer>(
+                        std::make_shared<StreamEnumerator>(in)
+                    );
+
+                    auto machine = std::make_shared<Json::Machine>();
+                    std::shared_ptr<Json::ITreeVisitor<Json::Pointer>> visitor
+                        = std::make_shared<Json::MyPostorderTreeVisitor>(machine);
+
+                    auto parse = Json::Parser<Json::Tree<Json::Pointer>>
+                        ::Tree<Json::MyTreeFactory>(lexer);
+
+                    parse.Tree->Accept(visitor);
+                };
+
+                auto staticParse = [&]() {
+                    std::stringstream in(document);
+                    auto lexer = std::make_shared<Json::Lexer>(
+                        std::make_shared<StreamEnumerator>(in)
+                    );
+
+                    auto machine = std::make_shared<Json::Machine>();
+                    Json::MyPostorderTreeVisitor visitor(machine);
+
+                    auto parse = Json::Parser<
+                        Json::Tree<Json::Pointer>,
+                        Json::MyTreeFactory
+                    >::Tree(lexer);
+
+                    Json::Accept(parse.Tree.get(), visitor);
+                };
+
+                out << "  " << document.size() << " bytes\n";
+                Report(out, "Virtual", Time(virtualParse, Iterations));
+                Report(out, "Static", Time(staticParse, Iterations));
+            }
+        },
+        {
+            "JsonValidate_Versus_RunMyParser",
+            [](std::ostream & out) {
+                const int COPIES = 200;
+                std::string document = LargeDocument(COPIES);
+
+                auto validate = [&]() {
+                    Json::Validate(document.data(), document.size());
+                };
+
+                auto parse = [&]() {
+                    std::stringstream in(document);
+                    Json::RunMyParser(in);
+                };
+
+                double megabytes = document.size() / (1024.0 * 1024.0);
+                double validateTime = Time(validate, Iterations);
+                double parseTime = Time(parse, Iterations);
+
+                out << "  " << document.size() << " bytes\n";
+                Report(out, "Validate", validateTime);
+                Report(out, "RunMyParser", parseTime);
+                out << "  Validate throughput: "
+                    << megabytes / (validateTime / 1000.0)
+                    << " MB/s\n";
+            }
+        },
+        {
+            "JsonTree_ArenaFactory_Versus_HeapFactory",
+            [](std::ostream & out) {
+                const int COPIES = 200;
+                std::string document = LargeDocument(COPIES);
+
+                typedef Json::ITreeFactory<Json::Tree<Json::Pointer>>::ptr_t
+                tree_t;
+
+                auto heapBuild = [&]() -> tree_t {
+                    std::stringstream in(document);
+
+                    return Json::Parser<
+                        Json::Tree<Json::Pointer>,
+                        Json::MyTreeFactory
+                    >::Tree(
+                        std::make_shared<Json::Lexer>(
+                            std::make_shared<StreamEnumerator>(in)
+                        )
+                    ).Tree;
+                };
+
+                auto arenaBuild = [&](std::shared_ptr<Json::Arena> arena) -> tree_t {
+                    std::stringstream in(document);
+
+                    return Json::Parser<
+                        Json::Tree<Json::Pointer>,
+                        Json::MyArenaTreeFactory
+                    >::Tree(
+                        std::make_unique<Json::MyArenaTreeFactory>(arena),
+                        std::make_shared<Json::Lexer>(
+                            std::make_shared<StreamEnumerator>(in)
+                        )
+                    ).Tree;
+                };
+
+                double heapBuildTime = 0;
+                double heapTeardownTime = 0;
+                double arenaBuildTime = 0;
+                double arenaTeardownTime = 0;
+                size_t heapAllocations = 0;
+                size_t arenaAllocations = 0;
+
+                for (int i = 0; i < Iterations; ++i) {
+                    tree_t tree;
+                    size_t before = Allocations();
+                    heapBuildTime += Time([&]() { tree = heapBuild(); }, 1);
+                    heapAllocations += Allocations() - before;
+                    heapTeardownTime += Time([&]() { tree.reset(); }, 1);
+                }
+
+                for (int i = 0; i < Iterations; ++i) {
+                    tree_t tree;
+                    auto arena = std::make_shared<Json::Arena>();
+                    size_t before = Allocations();
+                    arenaBuildTime += Time([&]() { tree = arenaBuild(arena); }, 1);
+                    arenaAllocations += Allocations() - before;
+
+                    arenaTeardownTime += Time([&]() {
+                        tree.reset();
+                        arena.reset();
+                    }, 1);
+                }
+
+                out << "  " << document.size() << " bytes\n";
+                Report(out, "Heap build", heapBuildTime / Iterations);
+                Report(out, "Heap teardown", heapTeardownTime / Iterations);
+                Report(out, "Arena build", arenaBuildTime / Iterations);
+                Report(out, "Arena teardown", arenaTeardownTime / Iterations);
+                out << "  Heap allocations:  " << heapAllocations / Iterations << '\n'
+                    << "  Arena allocations: " << arenaAllocations / Iterations << '\n';
+            }
+        },
+        {
+            "JsonTraversal_Versus_RecursiveAccept",
+            [](std::ostream & out) {
+                const int COPIES = 200;
+                std::string document = LargeDocument(COPIES);
+                std::stringstream in(document);
+
+                auto parse = Json::Parser<
+                    Json::Tree<Json::Pointer>,
+                    Json::MyTreeFactory
+                >::Tree(
+                    std::make_shared<Json::Lexer>(
+                        std::make_shared<StreamEnumerator>(in)
+                    )
+                );
+
+                Json::Traversal<Json::Pointer> traversal;
+
+                auto sharedAccept = [&]() {
+                    auto machine = std::make_shared<Json::Machine>();
+                    std::shared_ptr<Json::ITreeVisitor<Json::Pointer>> visitor
+                        = std::make_shared<Json::MyPostorderTreeVisitor>(machine);
+
+                    parse.Tree->Accept(visitor);
+                };
+
+                auto staticAccept = [&]() {
+                    auto machine = std::make_shared<Json::Machine>();
+                    Json::MyPostorderTreeVisitor visitor(machine);
+                    Json::Accept(parse.Tree.get(), visitor);
+                };
+
+                auto iterative = [&]() {
+                    auto machine = std::make_shared<Json::Machine>();
+                    Json::MyPostorderTreeVisitor visitor(machine);
+                    traversal.Postorder(parse.Tree.get(), visitor);
+                };
+
+                size_t before = Allocations();
+                sharedAccept();
+                size_t sharedAllocations = Allocations() - before;
+
+                before = Allocations();
+                iterative();
+                size_t iterativeAllocations = Allocations() - before;
+
+                out << "  " << document.size() << " bytes\n";
+                Report(out, "Recursive, shared_ptr", Time(sharedAccept, Iterations));
+                Report(out, "Recursive, reference", Time(staticAccept, Iterations));
+                Report(out, "Iterative", Time(iterative, Iterations));
+                out << "  Recursive allocations: " << sharedAllocations << '\n'
+                    << "  Iterative allocations: " << iterativeAllocations << '\n';
+            }
+        },
+        {
+            "JsonParallelPostorder_Versus_Sequential",
+            [](std::ostream & out) {
+                const int COPIES = 1000;
+                std::string document = LargeDocument(COPIES);
+                std::stringstream in(document);
+
+                auto parse = Json::Parser<
+                    Json::Tree<Json::Pointer>,
+                    Json::MyTreeFactory
+                >::Tree(
+                    std::make_shared<Json::Lexer>(
+                        std::make_shared<StreamEnumerator>(in)
+                    )
+                );
+
+                auto sequential = [&]() {
+                    auto machine = std::make_shared<Json::Machine>();
+                    Json::MyPostorderTreeVisitor visitor(machine);
+                    Json::Traversal<Json::Pointer>().Postorder(parse.Tree.get(), visitor);
+                };
+
+                auto parallel = [&]() {
+                    auto machine = std::make_shared<Json::Machine>();
+                    Json::MyPostorderTreeVisitor visitor(machine);
+                    Json::ParallelPostorder(parse.Tree.get(), visitor);
+                };
+
+                out << "  " << document.size() << " bytes, "
+                    << std::thread::hardware_concurrency() << " threads\n";
+                Report(out, "Sequential", Time(sequential, Iterations));
+                Report(out, "Parallel", Time(parallel, Iterations));
+            }
+        },
+        {
+            "JsonTape_Versus_JsonTree",
+            [](std::ostream & out) {
+                const int COPIES = 200;
+                std::string document = LargeDocument(COPIES);
+
+                auto tree = [&]() {
+                    std::stringstream in(document);
+                    Json::RunMyParser(in);
+                };
+
+                Json::Tape tape;
+
+                auto parseTape = [&]() {
+                    std::stringstream in(document);
+                    Json::ParseTape(in, tape);
+                };
+
+                auto tapeToMachine = [&]() {
+                    tape.ToMachine();
+                };
+
+                size_t before = Allocations();
+                tree();
+                size_t treeAllocations = Allocations() - before;
+
+                before = Allocations();
+                parseTape();
+                size_t tapeAllocations = Allocations() - before;
+
+                out << "  " << document.size() << " bytes, "
+                    << tape.Size() << " entries, "
+                    << tape.Strings().size() << " string bytes\n";
+                Report(out, "Tree to Machine", Time(tree, Iterations));
+                Report(out, "Tape", Time(parseTape, Iterations));
+                Report(out, "Tape to Machine", Time(tapeToMachine, Iterations));
+                out << "  Tree allocations: " << treeAllocations << '\n'
+                    << "  Tape allocations: " << tapeAllocations << '\n';
+            }
+        },
+        {
+            "JsonRawNumbers_Versus_ConvertedNumbers",
+            [](std::ostream & out) {
+                const int COPIES = 200;
+                std::string document = LargeDocument(COPIES);
+
+                auto converted = [&]() {
+                    std::stringstream in(document);
+                    Json::RunMyParser(in);
+                };
+
+                auto raw = [&]() {
+                    std::stringstream in(document);
+                    Json::ParseOptions options;
+                    options.RawNumbers = true;
+                    Json::RunMyParser(in, options);
+                };
+
+                out << "  " << document.size() << " bytes\n";
+                Report(out, "Converted", Time(converted, Iterations));
+                Report(out, "Raw", Time(raw, Iterations));
+            }
+        },
+        {
+            "JsonMachine_InternedStrings_Versus_SeparateStrings",
+            [](std::ostream & out) {
+                const int COPIES = 200;
+                std::string document = LargeDocument(COPIES);
+                Json::ParseOptions options;
+
+                auto separate = [&]() {
+                    std::stringstream in(document);
+                    Json::RunMyParser(in, options);
+                };
+
+                Json::ParseOptions interningOptions;
+                interningOptions.InternStrings = true;
+
+                auto interned = [&]() {
+                    std::stringstream in(document);
+                    Json::RunMyParser(in, interningOptions);
+                };
+
+                std::stringstream in(document);
+                auto result = Json::RunMyParser(in, interningOptions);
+
+                out << "  " << document.size() << " bytes, "
+                    << result.Machine->StringCount() << " strings\n";
+                Report(out, "Separate", Time(separate, Iterations));
+                Report(out, "Interned", Time(interned, Iterations));
+                out << "  Bytes saved: "
+                    << result.Machine->InternedBytesSaved() << '\n';
+            }
+        },
+        {
+            "JsonObject_FlatEntries_Versus_HashMapAndKeys",
+            [](std::ostream & out) {
+                const int OBJECTS = 10000;
+                const std::vector<std::string> keys = {
+                    "name", "age", "country", "kind", "id"
+                };
+
+                // The layout object_t had before: a hash map plus a
+                // second copy of the keys for their order
+                struct HashMapObject {
+                    std::unordered_map<std::string, Json::Pointer> map;
+                    std::vector<std::string> keys;
+                };
+
+                std::vector<Json::object_t> flat;
+                std::vector<HashMapObject> hashMap;
+
+                auto root = std::make_shared<Json::object_t::shape_t>();
+                size_t before = Allocations();
+                flat.resize(OBJECTS, Json::object_t(root));
+
+                for (auto & object : flat) {
+                    object.reserve(keys.size());
+
+                    for (size_t i = 0; i < keys.size(); ++i)
+                        object.add(keys[i], Json::Pointer { Json::Type::INTEGER, (Json::key_t)i });
+                }
+
+                size_t flatAllocations = Allocations() - before;
+                before = Allocations();
+                hashMap.resize(OBJECTS);
+
+                for (auto & object : hashMap)
+                    for (size_t i = 0; i < keys.size(); ++i) {
+                        object.map[keys[i]] = Json::Pointer { Json::Type::INTEGER, (Json::key_t)i };
+                        object.keys.push_back(keys[i]);
+                    }
+
+                size_t hashMapAllocations = Allocations() - before;
+                int sum = 0;
+
+                auto flatLookup = [&]() {
+                    for (auto & object : flat)
+                        for (auto & key : keys)
+                            sum += object.at(key).key;
+                };
+
+                auto hashMapLookup = [&]() {
+                    for (auto & object : hashMap)
+                        for (auto & key : keys)
+                            sum += object.map.at(key).key;
+                };
+
+                out << "  " << OBJECTS << " objects of " << keys.size() << " keys\n";
+                Report(out, "Flat lookup", Time(flatLookup, Iterations));
+                Report(out, "Hash map lookup", Time(hashMapLookup, Iterations));
+                out << "  Flat allocations: " << flatAllocations << '\n'
+                    << "  Hash map allocations: " << hashMapAllocations << '\n'
+                    << "  Flat bytes per object: "
+                    << sizeof(Json::object_t)
+                        + keys.size() * sizeof(Json::Pointer)
+                    << '\n';
+            }
+        },
+        {
+            "JsonObject_KeyCache_Versus_At",
+            [](std::ostream & out) {
+                const int COPIES = 200;
+                std::string document = LargeDocument(COPIES);
+                std::stringstream in(document);
+                auto result = Json::RunMyParser(in);
+                auto & machine = *result.Machine;
+
+                typedef Json::Machine::ResultSet<Json::Machine *> result_t;
+                auto all = [](result_t) { return true; };
+                std::vector<result_t> expenses;
+
+                for (auto & copy : machine.GetResultSet()["DOCUMENTS"].Where(all))
+                    for (auto & person : copy["PERSONS"].Where(all))
+                        for (auto & week : person["WEEK"].Where(all))
+                            for (auto & expense : week["EXPENSE"].Where(all))
+                                expenses.push_back(expense);
+
+                int found = 0;
+
+                auto at = [&]() {
+                    for (auto & expense : expenses)
+                        found += !expense.At("AMOUNT").IsNil()
+                            + !expense.At("WHAT").IsNil();
+                };
+
+                auto cached = [&]() {
+                    Json::key_cache_t amount("AMOUNT");
+                    Json::key_cache_t what("WHAT");
+
+                    for (auto & expense : expenses)
+                        found += !expense.At(amount).IsNil()
+                            + !expense.At(what).IsNil();
+                };
+
+                out << "  " << expenses.size() << " records\n";
+                Report(out, "At(string)", Time(at, Iterations));
+                Report(out, "At(key_cache_t)", Time(cached, Iterations));
+            }
+        },
+        {
+            "JsonPointerList_PackedBytes_Versus_Pointers",
+            [](std::ostream & out) {
+                const int COPIES = 2000;
+
+                for (auto path : {
+                    "res/input00.json",
+                    "res/input01.json",
+                    "res/input02.json"
+                }) {
+                    std::stringstream in(LargeDocument(path, COPIES));
+                    auto result = Json::RunMyParser(in);
+                    auto & machine = *result.Machine;
+
+                    size_t count = 0;
+                    size_t packed = 0;
+
+                    for (Json::key_t i = 0; i < machine.ListCount(); ++i) {
+                        count += machine.List(i).size();
+                        packed += machine.List(i).bytes();
+                    }
+
+                    for (Json::key_t i = 0; i < machine.ObjectCount(); ++i) {
+                        count += machine.Object(i).size();
+                        packed += machine.Object(i).values().bytes();
+                    }
+
+                    out << "  " << path << " x" << COPIES << ": "
+                        << count << " pointers, "
+                        << count * sizeof(Json::Pointer) << " bytes unpacked, "
+                        << packed << " bytes packed\n";
+                }
+            }
+        },
+        {
+            "JsonMachine_Stats",
+            [](std::ostream & out) {
+                const int COPIES = 200;
+                std::stringstream in(LargeDocument(COPIES));
+                auto result = Json::RunMyParser(in);
+                Json::MachineStats stats;
+
+                auto collect = [&]() {
+                    stats = result.Machine->Stats();
+                };
+
+                Report(out, "Stats", Time(collect, Iterations));
+                out << stats.ToString();
+            }
+        },
+        {
+            "JsonMachine_PreCount_Versus_Growing",
+            [](std::ostream & out) {
+                const int COPIES = 200;
+                std::string document = LargeDocument(COPIES);
+                Json::ParseOptions options;
+                Json::ParseOptions counting;
+                counting.PreCount = true;
+
+                auto growing = [&]() {
+                    Json::RunMyParser(document.data(), document.size(), options);
+                };
+
+                auto counted = [&]() {
+                    Json::RunMyParser(document.data(), document.size(), counting);
+                };
+
+                auto before = Json::RunMyParser(document.data(), document.size(), options)
+                    .Machine->Stats();
+                auto after = Json::RunMyParser(document.data(), document.size(), counting)
+                    .Machine->Stats();
+
+                out << "  " << document.size() << " bytes\n";
+                Report(out, "Growing", Time(growing, Iterations));
+                Report(out, "Pre-counted", Time(counted, Iterations));
+                out << "  Growths without pre-count: " << before.Total.Growths << '\n'
+                    << "  Growths with pre-count: " << after.Total.Growths << '\n';
+            }
+        },
+        {
+            "JsonSnapshot_Open_Versus_RunMyParser",
+            [](std::ostream & out) {
+                const int COPIES = 2000;
+                std::string document = LargeDocument(COPIES);
+
+                std::string path = (
+                    std::filesystem::temp_directory_path()
+                    / "JsonSnapshot_Benchmark.bin"
+                ).string();
+
+                std::shared_ptr<Json::Machine> machine;
+
+                auto parse = [&]() {
+                    machine = Json::RunMyParser(document.data(), document.size()).Machine;
+                };
+
+                auto save = [&]() {
+                    machine->SaveSnapshot(path);
+                };
+
+                std::shared_ptr<const Json::MappedMachine> mapped;
+
+                auto open = [&]() {
+                    mapped = Json::MappedMachine::Open(path);
+                };
+
+                std::string who;
+
+                auto query = [&]() {
+                    mapped->GetResultSet()["DOCUMENTS"][COPIES - 1]["PERSONS"][0]["WHO"]
+                        .AsString(who);
+                };
+
+                double parseTime = Time(parse, 1);
+                double saveTime = Time(save, 1);
+                double openTime = Time(open, Iterations);
+
+                out << "  " << document.size() << " bytes, snapshot of "
+                    << mapped->Size() << " bytes\n";
+                Report(out, "RunMyParser", parseTime);
+                Report(out, "SaveSnapshot", saveTime);
+                Report(out, "Open", openTime);
+                Report(out, "Open and query", openTime + Time(query, Iterations));
+
+                mapped = nullptr;
+                std::filesystem::remove(path);
+            }
+        },
+        {
+            "JsonMachine_Compact",
+            [](std::ostream & out) {
+                const int COPIES = 200;
+                std::string document = LargeDocument(COPIES);
+                auto machine = Json::RunMyParser(document.data(), document.size()).Machine;
+                auto documents = machine->GetResultSet()["DOCUMENTS"];
+
+                // Orphans every other copy
+                auto all = [](Json::Machine::ResultSet<Json::Machine *>) { return true; };
+                int index = 0;
+
+                for (auto & copy : documents.Where(all))
+                    if (index++ % 2)
+                        copy["PERSONS"].ChangeString("gone");
+
+                auto stats = machine->Stats();
+                size_t reclaimed = 0;
+
+                auto compact = [&]() {
+                    reclaimed = machine->Compact();
+                };
+
+                Report(out, "Compact", Time(compact, 1));
+                out << "  Bytes before: " << stats.Total.BytesReserved << '\n'
+                    << "  Bytes reclaimed: " << reclaimed << '\n';
+            }
+        },
+        {
+            "JsonParseSession_Versus_RunMyParser",
+            [](std::ostream & out) {
+                const int MESSAGES = 10000;
+
+                std::string message =
+                    "{ \"id\": 1042, \"symbol\": \"ACME\", \"side\": \"buy\", "
+                    "\"price\": 101.25, \"quantity\": 300, \"live\": true, "
+                    "\"venue\": { \"name\": \"exchange of the north\", \"code\": 7 }, "
+                    "\"flags\": [ \"a\", \"b\", \"c\" ] }";
+
+                Json::ParseSession session;
+                size_t allocations = 0;
+
+                auto fresh = [&]() {
+                    size_t before = Allocations();
+
+                    for (int i = 0; i < MESSAGES; ++i)
+                        Json::RunMyParser(message.data(), message.size());
+
+                    allocations = Allocations() - before;
+                };
+
+                auto reused = [&]() {
+                    size_t before = Allocations();
+
+                    for (int i = 0; i < MESSAGES; ++i)
+                        session.Parse(message);
+
+                    allocations = Allocations() - before;
+                };
+
+                out << "  " << MESSAGES << " messages of " << message.size() << " bytes\n";
+                Report(out, "RunMyParser", Time(fresh, 1));
+                out << "  Allocations per message: "
+                    << (double)allocations / MESSAGES << '\n';
+                Report(out, "ParseSession", Time(reused, 1));
+                out << "  Allocations per message: "
+                    << (double)allocations / MESSAGES << '\n';
+            }
+        },
+        {
+            "JsonVersionedMachine_Update_Versus_Copy",
+            [](std::ostream & out) {
+                const int COPIES = 200;
+                const int READERS = 4;
+                const int UPDATES = 1000;
+
+                std::stringstream in(LargeDocument(COPIES));
+                std::shared_ptr<const Json::Machine> base = Json::GetMachine(in);
+                Json::VersionedMachine machine(base);
+
+                auto copy = [&]() {
+                    Json::Machine copied(*base);
+                };
+
+                int next = 0;
+
+                auto update = [&]() {
+                    ++next;
+
+                    machine.Update([&](Json::MachineVersion & draft) {
+                        draft.GetResultSet()["DOCUMENTS"][next % COPIES]
+                            ["PERSONS"][0]["WEEK"][0]["NUMBER"].ChangeInteger(next);
+                    });
+                };
+
+                Report(out, "Copy Machine", Time(copy, Iterations));
+                Report(out, "Update one value", Time(update, UPDATES));
+
+                // Readers query while the writer publishes versions
+                std::atomic<bool> done(false);
+                std::atomic<size_t> reads(0);
+                std::vector<std::thread> readers;
+
+                for (int i = 0; i < READERS; ++i)
+                    readers.emplace_back([&, i]() {
+                        int value = 0;
+
+                        while (!done) {
+                            auto version = machine.Current();
+
+                            version->GetResultSet()["DOCUMENTS"][i % COPIES]
+                                ["PERSONS"][0]["WEEK"][0]["NUMBER"].AsInteger(value);
+
+                            ++reads;
+                        }
+                    });
+
+                double writing = Time(update, UPDATES);
+                done = true;
+
+                for (auto & reader : readers)
+                    reader.join();
+
+                Report(out, "Update, with readers", writing);
+                out << "  Reads during updates: " << reads << " by "
+                    << READERS << " readers\n"
+                    << "  Chunks copied by last update: "
+                    << machine.Current()->ChunksCopied() << '\n';
+            }
+        },
+        {
+            "JsonFrozenMachine_ConcurrentReaders",
+            [](std::ostream & out) {
+                const int COPIES = 200;
+                std::stringstream in(LargeDocument(COPIES));
+                Json::FrozenMachine frozen(std::move(*Json::RunMyParser(in).Machine));
+
+                typedef Json::FrozenMachine::result_set_t result_t;
+                auto all = [](result_t) { return true; };
+                std::vector<result_t> expenses;
+
+                for (auto & copy : frozen.GetResultSet()["DOCUMENTS"].Where(all))
+                    for (auto & person : copy["PERSONS"].Where(all))
+                        for (auto & week : person["WEEK"].Where(all))
+                            for (auto & expense : week["EXPENSE"].Where(all))
+                                expenses.push_back(expense);
+
+                // The same work for every reader, so that time stays
+                // flat as readers are added while there are cores
+                auto read = [&]() {
+                    Json::key_cache_t amount("AMOUNT");
+                    float total = 0;
+
+                    for (int pass = 0; pass < 20; ++pass)
+                        for (auto & expense : expenses) {
+                            float value = 0;
+                            expense.At(amount).AsFloat(value);
+                            total += value;
+                        }
+
+                    return total;
+                };
+
+                out << "  " << expenses.size() << " records, "
+                    << std::thread::hardware_concurrency() << " cores\n";
+
+                double single = 0;
+
+                for (int readers : { 1, 2, 4, 8 }) {
+                    auto run = [&]() {
+                        std::vector<std::thread> threads;
+
+                        for (int i = 0; i < readers; ++i)
+                            threads.emplace_back(read);
+
+                        for (auto & thread : threads)
+                            thread.join();
+                    };
+
+                    double time = Time(run, Iterations);
+
+                    if (readers == 1)
+                        single = time;
+
+                    Report(out, ToString(readers) + " readers", time);
+                    out << "  Reads per second, relative to 1 reader: "
+                        << readers * single / time << '\n';
+                }
+            }
+        },
+        {
+            "JsonMachine_Merge_Versus_Reparse",
+            [](std::ostream & out) {
+                const int WORKERS = 8;
+                const int COPIES = 25;
+                const int SCALARS = 1000000;
+                std::string document = LargeDocument(COPIES);
+                std::vector<std::shared_ptr<Json::Machine>> parts;
+
+                for (int i = 0; i < WORKERS; ++i)
+                    parts.push_back(Json::RunMyParser(document.data(), document.size()).Machine);
+
+                auto merge = [&]() {
+                    Json::Machine machine;
+                    auto list = machine.NewList();
+
+                    for (auto & part : parts) {
+                        auto root = machine.Merge(*part);
+                        machine.List(list.key).push_back(root);
+                    }
+                };
+
+                auto reparse = [&]() {
+                    std::string combined = "{ \"PARTS\": [ ";
+
+                    for (int i = 0; i < WORKERS; ++i)
+                        combined += (i ? ", " : "") + parts[i]->GetResultSet().ToString();
+
+                    combined += " ] }";
+                    Json::RunMyParser(combined.data(), combined.size());
+                };
+
+                // Scalar pools alone
+                Json::Machine scalars;
+                auto list = scalars.NewList();
+
+                for (int i = 0; i < SCALARS; ++i) {
+                    scalars.NewInteger(i);
+                    scalars.NewFloat((float)i);
+                    scalars.NewBoolean(i % 2);
+                }
+
+                auto object = scalars.NewObject();
+                scalars.Object(object.key).add("values", list);
+
+                auto mergeScalars = [&]() {
+                    Json::Machine machine;
+                    machine.NewBoolean(true);
+                    machine.Merge(scalars);
+                };
+
+                std::vector<char> bytes(SCALARS * (sizeof(int) + sizeof(float)));
+                std::vector<char> target;
+
+                auto copy = [&]() {
+                    target.assign(bytes.begin(), bytes.end());
+                };
+
+                out << "  " << WORKERS << " Machines of " << document.size() << " bytes\n";
+                Report(out, "Merge", Time(merge, Iterations));
+                Report(out, "ToString and reparse", Time(reparse, Iterations));
+                out << "  " << SCALARS << " each of integers, floats and booleans\n";
+                Report(out, "Merge", Time(mergeScalars, Iterations));
+                Report(out, "Copy of the same bytes", Time(copy, Iterations));
+            }
+        },
+        {
+            "JsonColumns_Versus_WhereAndAsFloat",
+            [](std::ostream & out) {
+                const int RECORDS = 1000000;
+
+                Json::Machine machine;
+                auto list = machine.NewList();
+
+                for (int i = 0; i < RECORDS; ++i) {
+                    auto record = machine.NewObject();
+                    auto price = machine.NewFloat((float)(i % 1000) / 10);
+                    auto quantity = machine.NewInteger(i % 7);
+                    auto & object = machine.Object(record.key);
+                    object.add("price", price);
+                    object.add("quantity", quantity);
+                    machine.List(list.key).push_back(record);
+                }
+
+                auto root = machine.NewObject();
+                machine.Object(root.key).add("records", list);
+                machine.SetStartingObject(root.key);
+
+                typedef Json::Machine::ResultSet<Json::Machine *> result_t;
+                auto all = [](result_t) { return true; };
+                auto records = machine.GetResultSet()["records"];
+                double check = 0;
+
+                auto where = [&]() {
+                    double sum = 0;
+                    double min = 0;
+                    double max = 0;
+                    size_t count = 0;
+
+                    for (auto & record : records.Where(all)) {
+                        float price = 0;
+
+                        if (!record["price"].AsFloat(price))
+                            continue;
+
+                        min = count && min < price ? min : price;
+                        max = count && max > price ? max : price;
+                        sum += price;
+                        ++count;
+                    }
+
+                    check = sum / count + min + max;
+                };
+
+                std::vector<Json::Column> columns;
+
+                auto extract = [&]() {
+                    columns = records.Columns({ "price", "quantity" });
+                };
+
+                auto aggregate = [&]() {
+                    auto & price = columns[0];
+                    check = price.Mean() + price.Min() + price.Max()
+                        + price.Sum() * 0 + price.Count() * 0;
+                };
+
+                extract();
+                out << "  " << RECORDS << " records\n";
+                Report(out, "Where and AsFloat", Time(where, Iterations));
+                Report(out, "Columns", Time(extract, Iterations));
+                Report(out, "Sum, Min, Max, Count, Mean", Time(aggregate, Iterations));
+                out << "  Mean price " << columns[0].Mean()
+                    << ", mean quantity " << columns[1].Mean() << '\n';
+            }
+        },
+        {
+            "JsonPatch_Diff_Versus_ToString",
+            [](std::ostream & out) {
+                const int COPIES = 200;
+                std::string document = LargeDocument(COPIES);
+                auto before = Json::RunMyParser(document.data(), document.size()).Machine;
+                auto after = Json::RunMyParser(document.data(), document.size()).Machine;
+                auto target = Json::RunMyParser(document.data(), document.size()).Machine;
+                auto documents = after->GetResultSet()["DOCUMENTS"];
+
+                documents[17]["PERSONS"][0]["WHO"].ChangeString("Jim");
+                documents[100]["link"]["retrieved"].ChangeString("2024_01_01");
+                documents[150]["PERSONS"][1]["WEEK"][1]["EXPENSE"][1]["AMOUNT"].ChangeFloat(7.5f);
+
+                Json::Patch patch;
+                bool same = false;
+
+                auto diff = [&]() {
+                    patch = before->Diff(*after);
+                };
+
+                auto unchanged = [&]() {
+                    same = before->Diff(*before).Operations.empty();
+                };
+
+                auto confirmed = [&]() {
+                    patch = before->Diff(*after, true);
+                };
+
+                auto apply = [&]() {
+                    target->Apply(patch);
+                };
+
+                auto text = [&]() {
+                    same = before->GetResultSet().ToString()
+                        == after->GetResultSet().ToString();
+                };
+
+                diff();
+                out << "  " << patch.Operations.size() << " operations\n";
+                Report(out, "Diff", Time(diff, Iterations));
+                Report(out, "Diff, unchanged", Time(unchanged, Iterations));
+                Report(out, "Diff, confirmed", Time(confirmed, Iterations));
+                Report(out, "Apply", Time(apply, Iterations));
+                Report(out, "ToString both", Time(text, Iterations));
+                out << "  Applied equal: "
+                    << (target->Diff(*after).Operations.empty() ? "yes" : "no") << '\n';
+            }
+        },
+        {
+            "JsonResultSet_Equals_Versus_ToString",
+            [](std::ostream & out) {
+                const int COPIES = 200;
+                std::string document = LargeDocument(COPIES);
+                auto machine = Json::RunMyParser(document.data(), document.size()).Machine;
+                auto other = Json::RunMyParser(document.data(), document.size()).Machine;
+
+                typedef Json::Machine::ResultSet<Json::Machine *> result_t;
+                auto all = [](result_t) { return true; };
+                std::vector<result_t> expenses;
+
+                for (auto & copy : machine->GetResultSet()["DOCUMENTS"].Where(all))
+                    for (auto & person : copy["PERSONS"].Where(all))
+                        for (auto & week : person["WEEK"].Where(all))
+                            for (auto & expense : week["EXPENSE"].Where(all))
+                                expenses.push_back(expense);
+
+                int found = 0;
+
+                auto text = [&]() {
+                    found = 0;
+
+                    for (auto & expense : expenses)
+                        found += !expense["WHAT"].ToString().compare("Car")
+                            + !expense["AMOUNT"].ToString().compare("20.00");
+                };
+
+                auto typed = [&]() {
+                    found = 0;
+
+                    for (auto & expense : expenses)
+                        found += expense["WHAT"].Equals("Car")
+                            + expense["AMOUNT"].Equals(20.0);
+                };
+
+                bool same = false;
+
+                auto wholeText = [&]() {
+                    same = machine->GetResultSet().ToString()
+                        == other->GetResultSet().ToString();
+                };
+
+                auto whole = [&]() {
+                    same = machine->GetResultSet().Equals(other->GetResultSet());
+                };
+
+                typed();
+                out << "  " << expenses.size() << " records, " << found << " found\n";
+                Report(out, "ToString and compare", Time(text, Iterations));
+                Report(out, "Equals", Time(typed, Iterations));
+                Report(out, "Documents, ToString", Time(wholeText, Iterations));
+                Report(out, "Documents, Equals", Time(whole, Iterations));
+
+                // Unequal documents differ by hash at the root
+                other->GetResultSet()["DOCUMENTS"][7]["PERSONS"][0]["WHO"].ChangeString("Jim");
+                whole();
+                out << "  Equal after a change: " << (same ? "yes" : "no") << '\n';
+                Report(out, "Documents, Equals, unequal", Time(whole, Iterations));
+            }
+        },
+        {
+            "JsonIndex_Versus_Scan",
+            [](std::ostream & out) {
+                const int RECORDS = 100000;
+                const int NAMES = 1000;
+                const int QUERIES = 100;
+
+                Json::Machine machine;
+                auto list = machine.NewList();
+
+                for (int i = 0; i < RECORDS; ++i) {
+                    auto record = machine.NewObject();
+                    auto name = machine.NewString("name" + ToString(i % NAMES));
+                    auto price = machine.NewFloat((float)(i % 1000) / 10);
+                    auto & object = machine.Object(record.key);
+                    object.add("name", name);
+                    object.add("price", price);
+                    machine.List(list.key).push_back(record);
+                }
+
+                auto root = machine.NewObject();
+                machine.Object(root.key).add("records", list);
+                machine.SetStartingObject(root.key);
+
+                typedef Json::Machine::ResultSet<Json::Machine *> result_t;
+                auto all = [](result_t) { return true; };
+                auto records = machine.GetResultSet()["records"];
+                size_t found = 0;
+
+                auto scan = [&]() {
+                    for (int q = 0; q < QUERIES; ++q) {
+                        std::string name = "name" + ToString(q * 7 % NAMES);
+                        double low = q % 90;
+
+                        for (auto & record : records.Where(all))
+                            found += record["name"].Equals(name);
+
+                        for (auto & record : records.Where(all)) {
+                            float price = 0;
+
+                            if (record["price"].AsFloat(price) && price >= low && price <= low + 0.5)
+                                ++found;
+                        }
+                    }
+                };
+
+                auto indexed = [&]() {
+                    for (int q = 0; q < QUERIES; ++q) {
+                        std::string name = "name" + ToString(q * 7 % NAMES);
+                        double low = q % 90;
+                        found += records.WhereEquals("name", name).size();
+                        found += records.WhereBetween("price", low, low + 0.5).size();
+                    }
+                };
+
+                // First use builds both indexes
+                auto build = [&]() {
+                    records[0]["price"].ChangeFloat(0);
+                    indexed();
+                };
+
+                out << "  " << RECORDS << " records, " << QUERIES
+                    << " equality and " << QUERIES << " range queries\n";
+
+                Report(out, "Where and Equals", Time(scan, Iterations));
+                Report(out, "Indexes, built", Time(build, Iterations));
+                Report(out, "Indexes, reused", Time(indexed, Iterations));
+            }
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "Benchmarks.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+std::vector<Benchmark> Benchmarks::_list;
+int Benchmarks::Iterations = 10;
+
+// Counts every allocation made through the global operator new. The
+// replacement is left out of programs that do not run the benchmarks.
+static std::atomic<size_t> _allocations(0);
+
+#ifdef RUN_BENCHMARKS
+void * operator new(size_t size) {
+    ++_allocations;
+
+    if (void * memory = std::malloc(size ? size : 1))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void * memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void * memory, size_t) noexcept {
+    std::free(memory);
+}
+#endif
+
+size_t Benchmarks::Allocations() {
+    return _allocations;
+}
+
+void Benchmarks::Run(std::ostream & out) {
+    for (auto benchmark : _list) {
+        out << benchmark.name << ":\n";
+        benchmark.definition(out);
+        out << '\n';
+    }
+}
+
+double Benchmarks::Time(
+    const std::function<void()> & definition,
+    int iterations
+) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; ++i)
+        definition();
+
+    std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / iterations;
+}
+
+std::string Benchmarks::LargeDocument(int copies) {
+    return LargeDocument("res/input02.json", copies);
+}
+
+std::string Benchmarks::LargeDocument(const std::string & path, int copies) {
+    FileReader inputReader;
+    std::string message;
+
+    if (!Tests::StartFileReader(
+        path,
+        message,
+        inputReader
+    ))
+        return "";
+
+    std::ostringstream document;
+    document << inputReader.Stream().rdbuf();
+    std::string copy = document.str();
+
+    document.str("");
+    document << "{ \"DOCUMENTS\": [ ";
+
+    for (int i = 0; i < copies; ++i) {
+        document << copy;
+
+        if (i < copies - 1)
+            document << ", ";
+    }
+
+    document << " ] }";
+    return document.str();
+}
+
+void Benchmarks::Report(
+    std::ostream & out,
+    const std::string & label,
+    double milliseconds
+) {
+    out << "  "
+        << std::left << std::setw(32) << label
+        << std::right << std::setw(10)
+        << std::fixed << std::setprecision(3) << milliseconds
+        << " ms\n";
+
+    out.unsetf(std::ios::floatfield);
+}
@@ -0,0 +1,51 @@
+#pragma once
+#ifndef _BENCHMARKS_H
+#define _BENCHMARKS_H
+
+#include "TestLexer.h"
+#include <functional>
+
+// Runs the benchmarks from demo.cpp and counts allocations through the
+// global operator new
+// #define RUN_BENCHMARKS
+
+typedef void (*benchmark_function_ptr)(std::ostream &);
+
+struct Benchmark {
+    std::string name;
+    benchmark_function_ptr definition;
+};
+
+class Benchmarks {
+    private:
+        static std::vector<Benchmark> _list;
+    public:
+        static int Iterations;
+
+        static void Init();
+        static void Run(std::ostream &);
+
+        // Average wall-clock milliseconds per call
+        static double Time(
+            const std::function<void()> & definition,
+            int iterations
+        );
+
+        // Copies of res/input02.json, listed under "DOCUMENTS"
+        static std::string LargeDocument(int copies);
+
+        // Copies of a file under the working directory
+        static std::string LargeDocument(const std::string & path, int copies);
+
+        static void Report(
+            std::ostream & out,
+            const std::string & label,
+            double milliseconds
+        );
+
+        // Calls to the global operator new since the program started,
+        // or 0 without RUN_BENCHMARKS
+        static size_t Allocations();
+};
+
+#endif
@@ -12,6 +12,8 @@
 #include "../src/MyJson.h"
 
 #include "FileReader.h"
+#include <cstring>
+#include <filesystem>
 #include <sstream>
 
 typedef bool (*test_function_ptr)(std::string&, std::string&);
@@ -488,6 +488,1826 @@ void Tests::Init() {
 
                 return success;
             }
+        },
+        {
+            "JsonProjection_Should_MaterializeOnlySelectedPaths",
+            [](std::string & actual, std::string & expected) -> bool {
+                FileReader inputReader;
+
+                if (!StartFileReader(
+                    "res/input02.json",
+                    actual,
+                    inputReader
+                )) {
+                    expected = "Input file opened successfully";
+                    return false;
+                }
+
+                Json::Projection projection;
+
+                if (!Json::Projection::New(
+                    {
+                        "PERSONS[*].WHO",
+                        "PERSONS[*].WEEK[*].EXPENSE[*].AMOUNT",
+                    },
+                    projection
+                )) {
+                    actual = "Projection could not be parsed";
+                    expected = "Projection parsed successfully";
+                    return false;
+                }
+
+                auto result = Json::RunMyParser(
+                    inputReader.Stream(),
+                    projection
+                );
+
+                if (!result.Success) {
+                    actual = result.Message;
+                    expected = "";
+                    return false;
+                }
+
+                actual = result.Machine
+                    ->GetResultSet()
+                    ["PERSONS"]
+                    [2]
+                    .ToString()
+                    ;
+                expected =
+                    "{ \"WHO\": \"Janet\", \"WEEK\": [ { \"EXPENSE\": [ { \"AMOUNT\": 19 }, { \"AMOUNT\": 18 }, { \"AMOUNT\": 18 } ] }, { \"EXPENSE\": [ { \"AMOUNT\": 17 } ] }, { \"EXPENSE\": [ { \"AMOUNT\": 14 }, { \"AMOUNT\": 12 }, { \"AMOUNT\": 19 }, { \"AMOUNT\": 12 } ] } ] }";
+
+                if (expected.compare(actual))
+                    return false;
+
+                actual = result.Machine
+                    ->GetResultSet()
+                    ["link"]
+                    .ToString()
+                    ;
+                expected = "";
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonParser_StaticDispatch_Should_MatchVirtualDispatch",
+            [](std::string & actual, std::string & expected) -> bool {
+                FileReader virtualReader;
+                FileReader staticReader;
+
+                if (!StartFileReader(
+                    "res/input02.json",
+                    actual,
+                    virtualReader
+                ) || !StartFileReader(
+                    "res/input02.json",
+                    actual,
+                    staticReader
+                )) {
+                    expected = "Input file opened successfully";
+                    return false;
+                }
+
+                auto virtualMachine = std::make_shared<Json::Machine>();
+                auto staticMachine = std::make_shared<Json::Machine>();
+
+                std::shared_ptr<Json::ITreeVisitor<Json::Pointer>> visitor
+                    = std::make_shared<Json::MyPostorderTreeVisitor>(virtualMachine);
+
+                auto virtualParse = Json::Parser<Json::Tree<Json::Pointer>>
+                    ::Tree<Json::MyTreeFactory>(
+                        std::make_shared<Json::Lexer>(
+                            std::make_shared<StreamEnumerator>(virtualReader.Stream())
+                        )
+                    );
+
+                virtualParse.Tree->Accept(visitor);
+
+                Json::MyPostorderTreeVisitor staticVisitor(staticMachine);
+
+                auto staticParse = Json::Parser<
+                    Json::Tree<Json::Pointer>,
+                    Json::MyTreeFactory
+                >::Tree(
+                    std::make_shared<Json::Lexer>(
+                        std::make_shared<StreamEnumerator>(staticReader.Stream())
+                    )
+                );
+
+                Json::Accept(staticParse.Tree.get(), staticVisitor);
+
+                expected = virtualMachine->ToString();
+                actual = staticMachine->ToString();
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonValidate_Should_ReportErrorCodeAndOffset",
+            [](std::string & actual, std::string & expected) -> bool {
+                std::vector<std::string> files = {
+                    "res/input02.json",
+                    "res/input03_incorrect.txt",
+                    "res/input04_incorrect.txt",
+                };
+
+                std::vector<Json::ValidationResult> expectedResults = {
+                    { true, Json::ErrorCode::NONE, 0 },
+                    { false, Json::ErrorCode::EXPECTED_COLON, 256 },
+                    { false, Json::ErrorCode::EXPECTED_CLOSING_BRACE, 655 },
+                };
+
+                for (size_t i = 0; i < files.size(); ++i) {
+                    FileReader inputReader;
+
+                    if (!StartFileReader(
+                        files[i],
+                        actual,
+                        inputReader
+                    )) {
+                        expected = "Input file opened successfully";
+                        return false;
+                    }
+
+                    auto result = Json::Validate(inputReader.Stream());
+
+                    actual = files[i] + ": "
+                        + ToString(result.Success) + ' '
+                        + ToString((int)result.Code) + ' '
+                        + ToString(result.Success ? 0 : result.Offset);
+
+                    expected = files[i] + ": "
+                        + ToString(expectedResults[i].Success) + ' '
+                        + ToString((int)expectedResults[i].Code) + ' '
+                        + ToString(expectedResults[i].Offset);
+
+                    if (expected.compare(actual))
+                        return false;
+
+                    // The same text from a buffer, read in place
+                    auto & stream = inputReader.Stream();
+                    stream.clear();
+                    stream.seekg(0);
+
+                    std::string text(
+                        (std::istreambuf_iterator<char>(stream)),
+                        std::istreambuf_iterator<char>()
+                    );
+
+                    result = Json::Validate(text.data(), text.size());
+
+                    actual = files[i] + ": "
+                        + ToString(result.Success) + ' '
+                        + ToString((int)result.Code) + ' '
+                        + ToString(result.Success ? 0 : result.Offset);
+
+                    if (expected.compare(actual))
+                        return false;
+                }
+
+                return true;
+            }
+        },
+        {
+            "JsonLimits_Should_FailFastWithSpecificError",
+            [](std::string & actual, std::string & expected) -> bool {
+                std::vector<Json::Limits> limits(5);
+                limits[1].MaxDepth = 6;
+                limits[2].MaxStringBytes = 10;
+                limits[3].MaxNodes = 10;
+                limits[4].MaxMachineBytes = 200;
+
+                std::vector<Json::ErrorCode> expectedCodes = {
+                    Json::ErrorCode::NONE,
+                    Json::ErrorCode::DEPTH_LIMIT_EXCEEDED,
+                    Json::ErrorCode::STRING_LIMIT_EXCEEDED,
+                    Json::ErrorCode::NODE_LIMIT_EXCEEDED,
+                    Json::ErrorCode::MEMORY_LIMIT_EXCEEDED,
+                };
+
+                for (size_t i = 0; i < limits.size(); ++i) {
+                    FileReader inputReader;
+
+                    if (!StartFileReader(
+                        "res/input02.json",
+                        actual,
+                        inputReader
+                    )) {
+                        expected = "Input file opened successfully";
+                        return false;
+                    }
+
+                    auto result = Json::Validate(
+                        inputReader.Stream(),
+                        limits[i]
+                    );
+
+                    actual = Json::ToString(result.Code);
+                    expected = Json::ToString(expectedCodes[i]);
+
+                    if (expected.compare(actual))
+                        return false;
+                }
+
+                FileReader inputReader;
+
+                if (!StartFileReader(
+                    "res/input02.json",
+                    actual,
+                    inputReader
+                )) {
+                    expected = "Input file opened successfully";
+                    return false;
+                }
+
+                auto result = Json::RunMyParser(
+                    inputReader.Stream(),
+                    limits[4]
+                );
+
+                expected = Json::ToString(Json::ErrorCode::MEMORY_LIMIT_EXCEEDED);
+                actual = result.Success
+                    ? "Success"
+                    : result.Message.substr(
+                        result.Message.length() - expected.length() - 1,
+                        expected.length()
+                    );
+
+                if (expected.compare(actual))
+                    return false;
+
+                // A session builds its Machine through a scan, which
+                // is charged the same budget
+                std::ifstream file(Tests::WorkingDirectory + "/res/input02.json");
+                std::stringstream document;
+                document << file.rdbuf();
+
+                Json::ParseOptions options;
+                options.Limits = limits[4];
+                Json::ParseSession session(options);
+                auto parsed = session.Parse(document.str());
+                actual = parsed.Success ? "Success" : parsed.Message;
+
+                if (expected.compare(actual))
+                    return false;
+
+                // An unterminated string of exactly the maximum length
+                // is a syntax error, not a limit violation
+                std::stringstream unterminated("{ \"key\": \"abcdefghij");
+                auto validation = Json::Validate(unterminated, limits[2]);
+                actual = Json::ToString(validation.Code);
+
+                return validation.Code != Json::ErrorCode::NONE
+                    && validation.Code != Json::ErrorCode::STRING_LIMIT_EXCEEDED;
+            }
+        },
+        {
+            "JsonArena_Should_BuildSameMachineAsHeapFactory",
+            [](std::string & actual, std::string & expected) -> bool {
+                FileReader heapReader;
+                FileReader arenaReader;
+
+                if (!StartFileReader(
+                    "res/input02.json",
+                    actual,
+                    heapReader
+                ) || !StartFileReader(
+                    "res/input02.json",
+                    actual,
+                    arenaReader
+                )) {
+                    expected = "Input file opened successfully";
+                    return false;
+                }
+
+                auto heapMachine = std::make_shared<Json::Machine>();
+                auto arenaMachine = std::make_shared<Json::Machine>();
+                auto arena = std::make_shared<Json::Arena>();
+
+                auto heapParse = Json::Parser<
+                    Json::Tree<Json::Pointer>,
+                    Json::MyTreeFactory
+                >::Tree(
+                    std::make_shared<Json::Lexer>(
+                        std::make_shared<StreamEnumerator>(heapReader.Stream())
+                    )
+                );
+
+                auto arenaParse = Json::Parser<
+                    Json::Tree<Json::Pointer>,
+                    Json::MyArenaTreeFactory
+                >::Tree(
+                    std::make_unique<Json::MyArenaTreeFactory>(arena),
+                    std::make_shared<Json::Lexer>(
+                        std::make_shared<StreamEnumerator>(arenaReader.Stream())
+                    )
+                );
+
+                expected = "Heap 0, Arena 1";
+                actual = "Heap " + ToString((int)heapParse.Tree->InArena())
+                    + ", Arena " + ToString((int)arenaParse.Tree->InArena());
+
+                if (expected.compare(actual))
+                    return false;
+
+                Json::MyPostorderTreeVisitor heapVisitor(heapMachine);
+                Json::MyPostorderTreeVisitor arenaVisitor(arenaMachine);
+                Json::Accept(heapParse.Tree.get(), heapVisitor);
+                Json::Accept(arenaParse.Tree.get(), arenaVisitor);
+
+                expected = heapMachine->ToString();
+                actual = arenaMachine->ToString();
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonTraversal_Should_MatchRecursiveAccept",
+            [](std::string & actual, std::string & expected) -> bool {
+                // Writes the same text as Machine::ResultSet::ToString
+                class Printer final: public Json::IPreorderVisitor {
+                    private:
+                        std::ostringstream _out;
+                        std::vector<bool> _first;
+                        bool _after_key = false;
+
+                        void Separate() {
+                            if (_after_key || _first.empty()) {
+                                _after_key = false;
+                                return;
+                            }
+
+                            if (!_first.back())
+                                _out << ", ";
+
+                            _first.back() = false;
+                        }
+                    public:
+                        std::string Text() const {
+                            return _out.str();
+                        }
+
+                        virtual void StartObject() override {
+                            Separate();
+                            _out << "{ ";
+                            _first.push_back(true);
+                        }
+
+                        virtual void Key(const Json::tree_string_t & key) override {
+                            Separate();
+                            _out << '"' << key << "\": ";
+                            _after_key = true;
+                        }
+
+                        virtual void EndObject() override {
+                            _first.pop_back();
+                            _out << " }";
+                        }
+
+                        virtual void StartList() override {
+                            Separate();
+                            _out << "[ ";
+                            _first.push_back(true);
+                        }
+
+                        virtual void EndList() override {
+                            _first.pop_back();
+                            _out << " ]";
+                        }
+
+                        virtual void ForString(const Json::tree_string_t & value) override {
+                            Separate();
+                            _out << '"' << value << '"';
+                        }
+
+                        virtual void ForNumeric(Homonumeric value) override {
+                            Separate();
+
+                            switch (value.Mode) {
+                                case Homonumeric::Mode::INTEGER:
+                                    _out << value.Payload.Integer;
+                                    break;
+                                case Homonumeric::Mode::FLOAT:
+                                    _out << value.Payload.Float;
+                                    break;
+                                case Homonumeric::Mode::BOOLEAN:
+                                    _out << (value.Payload.Boolean ? "true" : "false");
+                                    break;
+                                default:
+                                    break;
+                            }
+                        }
+
+                        virtual void Null() override {
+                            Separate();
+                            _out << "null";
+                        }
+                };
+
+                FileReader inputReader;
+
+                if (!StartFileReader(
+                    "res/input02.json",
+                    actual,
+                    inputReader
+                )) {
+                    expected = "Input file opened successfully";
+                    return false;
+                }
+
+                auto parse = Json::Parser<
+                    Json::Tree<Json::Pointer>,
+                    Json::MyTreeFactory
+                >::Tree(
+                    std::make_shared<Json::Lexer>(
+                        std::make_shared<StreamEnumerator>(inputReader.Stream())
+                    )
+                );
+
+                auto recursiveMachine = std::make_shared<Json::Machine>();
+                auto iterativeMachine = std::make_shared<Json::Machine>();
+                Json::MyPostorderTreeVisitor recursiveVisitor(recursiveMachine);
+                Json::MyPostorderTreeVisitor iterativeVisitor(iterativeMachine);
+                Json::Traversal<Json::Pointer> traversal;
+
+                Json::Accept(parse.Tree.get(), recursiveVisitor);
+                traversal.Postorder(parse.Tree.get(), iterativeVisitor);
+
+                expected = recursiveMachine->ToString();
+                actual = iterativeMachine->ToString();
+
+                if (expected.compare(actual))
+                    return false;
+
+                Printer printer;
+                traversal.Preorder(parse.Tree.get(), printer);
+
+                expected = recursiveMachine->GetResultSet().ToString();
+                actual = printer.Text();
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonTraversal_Should_VisitNullsInPreorder",
+            [](std::string & actual, std::string & expected) -> bool {
+                class Recorder final: public Json::IPreorderVisitor {
+                    public:
+                        std::string Text;
+
+                        virtual void StartObject() override { Text += "{ "; }
+                        virtual void EndObject() override { Text += "} "; }
+                        virtual void StartList() override { Text += "[ "; }
+                        virtual void EndList() override { Text += "] "; }
+                        virtual void Null() override { Text += "null "; }
+
+                        virtual void Key(const Json::tree_string_t & key) override {
+                            Text += std::string(key) + ": ";
+                        }
+
+                        virtual void ForString(const Json::tree_string_t & value) override {
+                            Text += '"' + std::string(value) + "\" ";
+                        }
+
+                        virtual void ForNumeric(Homonumeric value) override {
+                            Text += ToString(value.Payload.Integer) + ' ';
+                        }
+                };
+
+                std::istringstream input("{\"a\": null, \"b\": [null, 1]}");
+
+                auto parse = Json::Parser<
+                    Json::Tree<Json::Pointer>,
+                    Json::MyTreeFactory
+                >::Tree(
+                    std::make_shared<Json::Lexer>(
+                        std::make_shared<StreamEnumerator>(input)
+                    )
+                );
+
+                Recorder recorder;
+                Json::Traversal<Json::Pointer>().Preorder(parse.Tree.get(), recorder);
+
+                expected = "{ a: null b: [ null 1 ] } ";
+                actual = recorder.Text;
+
+                if (expected.compare(actual))
+                    return false;
+
+                // A null document
+                std::istringstream null("null");
+
+                parse = Json::Parser<
+                    Json::Tree<Json::Pointer>,
+                    Json::MyTreeFactory
+                >::Tree(
+                    std::make_shared<Json::Lexer>(
+                        std::make_shared<StreamEnumerator>(null)
+                    )
+                );
+
+                recorder.Text.clear();
+                Json::Traversal<Json::Pointer>().Preorder(parse.Tree.get(), recorder);
+
+                expected = "null ";
+                actual = recorder.Text;
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonParallel_Should_MatchSequentialPostorder",
+            [](std::string & actual, std::string & expected) -> bool {
+                FileReader inputReader;
+
+                if (!StartFileReader(
+                    "res/input02.json",
+                    actual,
+                    inputReader
+                )) {
+                    expected = "Input file opened successfully";
+                    return false;
+                }
+
+                auto parse = Json::Parser<
+                    Json::Tree<Json::Pointer>,
+                    Json::MyTreeFactory
+                >::Tree(
+                    std::make_shared<Json::Lexer>(
+                        std::make_shared<StreamEnumerator>(inputReader.Stream())
+                    )
+                );
+
+                auto sequentialMachine = std::make_shared<Json::Machine>();
+                Json::MyPostorderTreeVisitor sequentialVisitor(sequentialMachine);
+                Json::Traversal<Json::Pointer>().Postorder(parse.Tree.get(), sequentialVisitor);
+                expected = sequentialMachine->GetResultSet().ToString();
+
+                // Small enough to fork at every level
+                std::vector<size_t> thresholds = { 1, 16, Json::PARALLEL_THRESHOLD };
+
+                // One thread runs it all in place
+                std::vector<size_t> threadCounts = { 1, 4, Json::PARALLEL_THREADS };
+
+                for (auto threshold : thresholds) {
+                    for (auto threads : threadCounts) {
+                        auto parallelMachine = std::make_shared<Json::Machine>();
+                        Json::MyPostorderTreeVisitor parallelVisitor(parallelMachine);
+
+                        Json::ParallelPostorder(
+                            parse.Tree.get(),
+                            parallelVisitor,
+                            threshold,
+                            threads
+                        );
+
+                        actual = parallelMachine->GetResultSet().ToString();
+
+                        if (expected.compare(actual))
+                            return false;
+                    }
+                }
+
+                return true;
+            }
+        },
+        {
+            "JsonTape_Should_MatchTreeAndMachine",
+            [](std::string & actual, std::string & expected) -> bool {
+                FileReader treeReader;
+                FileReader tapeReader;
+
+                if (!StartFileReader(
+                    "res/input02.json",
+                    actual,
+                    treeReader
+                ) || !StartFileReader(
+                    "res/input02.json",
+                    actual,
+                    tapeReader
+                )) {
+                    expected = "Input file opened successfully";
+                    return false;
+                }
+
+                auto parse = Json::Parser<
+                    Json::Tree<Json::Pointer>,
+                    Json::MyTreeFactory
+                >::Tree(
+                    std::make_shared<Json::Lexer>(
+                        std::make_shared<StreamEnumerator>(treeReader.Stream())
+                    )
+                );
+
+                Json::Tape tape;
+                auto result = Json::ParseTape(tapeReader.Stream(), tape);
+
+                expected = "Success";
+                actual = result.Success ? "Success" : "Failure";
+
+                if (expected.compare(actual))
+                    return false;
+
+                expected = "0 " + ToString((int)tape.Size() - 1);
+                actual = ToString((int)tape.Match(tape.Size() - 1)) + ' '
+                    + ToString((int)tape.Match(0));
+
+                if (expected.compare(actual))
+                    return false;
+
+                auto treeMachine = std::make_shared<Json::Machine>();
+                auto tapeMachine = std::make_shared<Json::Machine>();
+                Json::MyPostorderTreeVisitor treeVisitor(treeMachine);
+                Json::MyPostorderTreeVisitor tapeVisitor(tapeMachine);
+                Json::Accept(parse.Tree.get(), treeVisitor);
+                tape.Accept<Json::Pointer>(tapeVisitor);
+
+                expected = treeMachine->ToString();
+                actual = tapeMachine->ToString();
+
+                if (expected.compare(actual))
+                    return false;
+
+                expected = treeMachine->GetResultSet().ToString();
+                actual = tape.ToMachine()->GetResultSet().ToString();
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonRawNumbers_Should_ConvertOnReadAndKeepText",
+            [](std::string & actual, std::string & expected) -> bool {
+                std::stringstream input(
+                    "{ \"a\": 1.50, \"b\": 2e3, \"c\": -7, \"d\": [ 0.25E-1, 42 ] }"
+                );
+
+                Json::ParseOptions options;
+                options.RawNumbers = true;
+                auto result = Json::RunMyParser(input, options);
+
+                if (!result.Success) {
+                    expected = "Success";
+                    actual = result.Message;
+                    return false;
+                }
+
+                auto document = result.Machine->GetResultSet();
+
+                expected = "{ \"a\": 1.50, \"b\": 2e3, \"c\": -7, \"d\": [ 0.25E-1, 42 ] }";
+                actual = document.ToString();
+
+                if (expected.compare(actual))
+                    return false;
+
+                int c = 0;
+                float b = 0;
+                float d = 0;
+
+                document["c"].AsInteger(c);
+                document["b"].AsFloat(b);
+                document["d"][0].AsFloat(d);
+
+                expected = "-7 2000 0.025";
+                actual = ToString(c) + ' ' + ToString((int)b) + ' '
+                    + (d > 0.0249 && d < 0.0251 ? "0.025" : "?");
+
+                if (expected.compare(actual))
+                    return false;
+
+                document["c"].ChangeInteger(8);
+
+                expected = "8";
+                actual = document["c"].ToString();
+
+                if (expected.compare(actual))
+                    return false;
+
+                FileReader inputReader;
+
+                if (!StartFileReader(
+                    "res/input02.json",
+                    actual,
+                    inputReader
+                )) {
+                    expected = "Input file opened successfully";
+                    return false;
+                }
+
+                auto persons = Json::RunMyParser(inputReader.Stream(), options);
+
+                auto amount = persons.Machine->GetResultSet()
+                    ["PERSONS"][0]["WEEK"][0]["EXPENSE"][0]["AMOUNT"];
+
+                float value = 0;
+                amount.AsFloat(value);
+
+                // Text as written in the file
+                expected = "18.00 18";
+                actual = amount.ToString() + ' ' + ToString((int)value);
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonRawNumbers_Should_KeepOutOfRangeIntegersAsFloats",
+            [](std::string & actual, std::string & expected) -> bool {
+                std::stringstream input(
+                    "{ \"a\": [ 3000000000, -2147483648, -99999999999 ] }"
+                );
+
+                Json::ParseOptions options;
+                options.RawNumbers = true;
+                auto result = Json::RunMyParser(input, options);
+
+                if (!result.Success) {
+                    expected = "Success";
+                    actual = result.Message;
+                    return false;
+                }
+
+                auto document = result.Machine->GetResultSet()["a"];
+
+                // Keeps the text
+                expected = "[ 3000000000, -2147483648, -99999999999 ]";
+                actual = document.ToString();
+
+                if (expected.compare(actual))
+                    return false;
+
+                int integer = 0;
+                float big = 0;
+                float negative = 0;
+
+                bool bigIsInteger = document[0].AsInteger(integer);
+                bool bigIsFloat = document[0].AsFloat(big);
+                document[1].AsInteger(integer);
+                document[2].AsFloat(negative);
+
+                expected = "0 1 3e+09 -2147483648 -1e+11";
+                actual = ToString(bigIsInteger) + ' ' + ToString(bigIsFloat) + ' '
+                    + ToString(big) + ' ' + ToString(integer) + ' '
+                    + ToString(negative);
+
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonMachine_Should_InternStringsAndCopyOnWrite",
+            [](std::string & actual, std::string & expected) -> bool {
+                std::stringstream input(
+                    "{ \"cars\": [ { \"kind\": \"Car\", \"id\": \"a\" }, "
+                    "{ \"kind\": \"Car\", \"id\": \"b\" }, "
+                    "{ \"kind\": \"Car\", \"id\": \"a\" } ] }"
+                );
+
+                Json::ParseOptions options;
+                options.InternStrings = true;
+                auto result = Json::RunMyParser(input, options);
+
+                if (!result.Success) {
+                    expected = "Success";
+                    actual = result.Message;
+                    return false;
+                }
+
+                auto document = result.Machine->GetResultSet();
+
+                expected = "{ \"cars\": [ { \"kind\": \"Car\", \"id\": \"a\" }, "
+                    "{ \"kind\": \"Car\", \"id\": \"b\" }, "
+                    "{ \"kind\": \"Car\", \"id\": \"a\" } ] }";
+                actual = document.ToString();
+
+                if (expected.compare(actual))
+                    return false;
+
+                expected = "6 strings";
+                actual = ToString(result.Machine->StringCount()) + " strings";
+
+                if (expected.compare(actual))
+                    return false;
+
+                document["cars"][1]["kind"].ChangeString("Truck");
+
+                expected = "Car Truck Car";
+                actual = document["cars"][0]["kind"].ToString() + ' '
+                    + document["cars"][1]["kind"].ToString() + ' '
+                    + document["cars"][2]["kind"].ToString();
+
+                if (expected.compare(actual))
+                    return false;
+
+                // Strings added after interning is turned off are
+                // never shared
+                result.Machine->SetInterning(false);
+                auto key = result.Machine->NewString("Car");
+                result.Machine->String(key.key) = "Bus";
+
+                expected = "Bus Car";
+                actual = std::string(std::as_const(*result.Machine).String(key.key))
+                    + ' ' + document["cars"][2]["kind"].ToString();
+
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonObject_Should_KeepInsertionOrderAcrossIndexThreshold",
+            [](std::string & actual, std::string & expected) -> bool {
+                Json::object_t object;
+                const int COUNT = 3 * (int)Json::object_t::shape_t::INDEX_THRESHOLD;
+
+                for (int i = 0; i < COUNT; ++i)
+                    object.add("key" + ToString(i), Json::Pointer { Json::Type::INTEGER, i });
+
+                expected = "";
+                actual = "";
+
+                for (int i = 0; i < COUNT; ++i) {
+                    std::string key = "key" + ToString(i);
+                    expected += key + '=' + ToString(i) + ' ';
+                    actual += object.keys()[i] + '=' + ToString(object.at(key).key) + ' ';
+                }
+
+                if (expected.compare(actual))
+                    return false;
+
+                object["key1"] = Json::Pointer { Json::Type::INTEGER, 100 };
+                object["extra"] = Json::Pointer { Json::Type::BOOLEAN, 1 };
+
+                expected = "false true 100 extra Nil";
+                actual = std::string(object.add("key0", Json::Pointer()) ? "true" : "false")
+                    + ' ' + (object.hasKey("extra") ? "true" : "false")
+                    + ' ' + ToString(object.at("key1").key)
+                    + ' ' + object.keys()[COUNT]
+                    + ' ' + Json::ToString(object.at("missing").type);
+
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonObject_Should_ShareShapesAndCacheKeys",
+            [](std::string & actual, std::string & expected) -> bool {
+                std::stringstream input(
+                    "{ \"people\": [ "
+                    "{ \"name\": \"Ann\", \"age\": 30 }, "
+                    "{ \"name\": \"Bob\", \"age\": 41 }, "
+                    "{ \"age\": 52, \"name\": \"Cal\" }, "
+                    "{ \"name\": \"Dee\" } ] }"
+                );
+
+                auto result = Json::RunMyParser(input);
+
+                if (!result.Success) {
+                    expected = "Success";
+                    actual = result.Message;
+                    return false;
+                }
+
+                auto & machine = *result.Machine;
+                auto people = machine.GetResultSet()["people"];
+
+                // Same keys in the same order share a shape. The
+                // records are built before the object holding them.
+                auto shape = [&](int i) {
+                    return machine.Object(i).shape().get();
+                };
+
+                expected = "true false false";
+                actual = std::string(shape(0) == shape(1) ? "true" : "false")
+                    + ' ' + (shape(0) == shape(2) ? "true" : "false")
+                    + ' ' + (shape(0) == shape(3) ? "true" : "false");
+
+                if (expected.compare(actual))
+                    return false;
+
+                Json::key_cache_t name("name");
+                Json::key_cache_t age("age");
+
+                expected = "Ann 30, Bob 41, Cal 52, Dee , ";
+                actual = "";
+
+                for (int i = 0; i < 4; ++i)
+                    actual += people[i].At(name).ToString() + ' '
+                        + people[i].At(age).ToString() + ", ";
+
+                if (expected.compare(actual))
+                    return false;
+
+                // Past MAX_SHARED_KEYS, an object has a shape of its
+                // own, which copies share until one of them changes
+                Json::object_t wide;
+                const int COUNT = (int)Json::object_t::shape_t::MAX_SHARED_KEYS + 4;
+
+                for (int i = 0; i < COUNT; ++i)
+                    wide.add("key" + ToString(i), Json::Pointer { Json::Type::INTEGER, i });
+
+                Json::object_t copy = wide;
+                copy.add("extra", Json::Pointer { Json::Type::BOOLEAN, 0 });
+                Json::key_cache_t last("key" + ToString(COUNT - 1));
+
+                expected = "true false true " + ToString(COUNT - 1) + ' ' + ToString(COUNT - 1);
+                actual = std::string(wide.shape()->dictionary() ? "true" : "false")
+                    + ' ' + (wide.hasKey("extra") ? "true" : "false")
+                    + ' ' + (copy.hasKey("extra") ? "true" : "false")
+                    + ' ' + ToString(last.at(wide).key)
+                    + ' ' + ToString(last.at(copy).key);
+
+                if (expected.compare(actual))
+                    return false;
+
+                // Past MAX_TRANSITIONS different first keys, objects
+                // stop adding shapes to the tree
+                Json::Machine varied;
+                const int VARIED = (int)Json::object_t::shape_t::MAX_TRANSITIONS + 8;
+
+                for (int i = 0; i < VARIED; ++i) {
+                    auto & object = varied.Object(varied.NewObject().key);
+                    object["first" + ToString(i)] = Json::Pointer { Json::Type::INTEGER, i };
+                    object["second"] = Json::Pointer { Json::Type::INTEGER, i };
+                }
+
+                const int SHARED = (int)Json::object_t::shape_t::MAX_TRANSITIONS;
+
+                expected = "false true " + ToString(VARIED - 1);
+                actual = std::string(varied.Object(SHARED - 1).shape()->dictionary() ? "true" : "false")
+                    + ' ' + (varied.Object(SHARED).shape()->dictionary() ? "true" : "false")
+                    + ' ' + ToString(varied.Object(VARIED - 1).at("second").key);
+
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonPointerList_Should_PackAndEscapeLargeKeys",
+            [](std::string & actual, std::string & expected) -> bool {
+                Json::list_t list;
+                list.push_back(Json::Pointer { Json::Type::STRING, 5 });
+                list.push_back(Json::Pointer { Json::Type::NIL, 0 });
+                list.push_back(Json::Pointer { Json::Type::LIST, Json::list_t::MAX_PACKED_KEY });
+
+                auto describe = [&]() {
+                    std::string text = list.wide() ? "wide" : "packed";
+
+                    for (Json::Pointer value : list)
+                        text += ' ' + Json::ToString(value.type) + ':' + ToString(value.key);
+
+                    return text + " (" + ToString((int)list.bytes()) + " bytes)";
+                };
+
+                expected = "packed String:5 Nil:0 List:"
+                    + ToString(Json::list_t::MAX_PACKED_KEY) + " (12 bytes)";
+                actual = describe();
+
+                if (expected.compare(actual))
+                    return false;
+
+                list.push_back(Json::Pointer { Json::Type::OBJECT, Json::list_t::MAX_PACKED_KEY + 1 });
+                list[0] = Json::Pointer { Json::Type::FLOAT, 7 };
+
+                expected = "wide Float:7 Nil:0 List:"
+                    + ToString(Json::list_t::MAX_PACKED_KEY) + " Object:"
+                    + ToString(Json::list_t::MAX_PACKED_KEY + 1) + " (32 bytes)";
+                actual = describe();
+
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonMachine_Stats_Should_CountEveryPool",
+            [](std::string & actual, std::string & expected) -> bool {
+                std::stringstream input(
+                    "{ \"name\": \"A string far too long to fit in the small-string buffer\", "
+                    "\"short\": \"abc\", \"n\": [ 1, 2, 3 ], \"x\": 1.5, \"ok\": true, "
+                    "\"inner\": { \"y\": false } }"
+                );
+
+                auto result = Json::RunMyParser(input);
+
+                if (!result.Success) {
+                    expected = "Success";
+                    actual = result.Message;
+                    return false;
+                }
+
+                auto stats = result.Machine->Stats();
+
+                expected = "2 3 1 2 1 2 0";
+                actual = ToString((int)stats.Strings.Count) + ' '
+                    + ToString((int)stats.Integers.Count) + ' '
+                    + ToString((int)stats.Floats.Count) + ' '
+                    + ToString((int)stats.Booleans.Count) + ' '
+                    + ToString((int)stats.Lists.Count) + ' '
+                    + ToString((int)stats.Objects.Count) + ' '
+                    + ToString((int)stats.RawNumbers.Count);
+
+                if (expected.compare(actual))
+                    return false;
+
+                expected = "true true true";
+                actual = std::string(stats.Strings.StringBytes > 50 ? "true" : "false")
+                    + ' ' + (stats.Total.BytesUsed <= stats.Total.BytesReserved ? "true" : "false")
+                    + ' ' + (stats.Total.Count == 11 ? "true" : "false");
+
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonMachine_PreCount_Should_AllocateEachPoolOnce",
+            [](std::string & actual, std::string & expected) -> bool {
+                std::string input =
+                    "{ \"a\": [ 1, 2, 3, 4, 5 ], \"b\": [ 1.5, 2.5, 3.5 ], "
+                    "\"c\": [ true, false, true ], \"d\": [ \"x\", \"y\", \"z\" ], "
+                    "\"e\": [ { \"f\": null }, { \"f\": [ 7 ] } ] }";
+
+                Json::ParseOptions options;
+                auto plain = Json::RunMyParser(input.data(), input.size(), options);
+
+                options.PreCount = true;
+                auto counted = Json::RunMyParser(input.data(), input.size(), options);
+
+                if (!plain.Success || !counted.Success) {
+                    expected = "Success";
+                    actual = plain.Message + counted.Message;
+                    return false;
+                }
+
+                expected = plain.Machine->GetResultSet().ToString();
+                actual = counted.Machine->GetResultSet().ToString();
+
+                if (expected.compare(actual))
+                    return false;
+
+                auto before = plain.Machine->Stats();
+                auto after = counted.Machine->Stats();
+
+                // Reserve allocates before the first value is added
+                expected = "more than 6, 0";
+                actual = (before.Total.Growths > 6 ? "more than 6, " : "6 or fewer, ")
+                    + ToString((int)after.Total.Growths);
+
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonCountValues_Should_CountEachKindWithoutKeys",
+            [](std::string & actual, std::string & expected) -> bool {
+                std::string input =
+                    "{ \"k\": \"a\\\"b\", \"l\" : [ 1, 2.5, -3e2, true, null ], "
+                    "\"m\": { \"\\\\\": \"\\\\\" } }";
+
+                Json::PoolSizes sizes;
+                Json::CountValues(input.data(), input.size(), sizes);
+
+                expected = "2 1 2 1 2 1";
+                actual = ToString(sizes.Objects) + ' ' + ToString(sizes.Lists) + ' '
+                    + ToString(sizes.Strings) + ' ' + ToString(sizes.Integers) + ' '
+                    + ToString(sizes.Floats) + ' ' + ToString(sizes.Booleans);
+
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonSnapshot_Should_ServeSameResultSetFromMapping",
+            [](std::string & actual, std::string & expected) -> bool {
+                FileReader inputReader;
+
+                if (!StartFileReader(
+                    "res/input02.json",
+                    actual,
+                    inputReader
+                )) {
+                    expected = "Input file opened successfully";
+                    return false;
+                }
+
+                Json::ParseOptions options;
+                options.RawNumbers = true;
+                options.InternStrings = true;
+                auto result = Json::RunMyParser(inputReader.Stream(), options);
+
+                if (!result.Success) {
+                    expected = "Success";
+                    actual = result.Message;
+                    return false;
+                }
+
+                // Enough keys to be found by binary search
+                auto & machine = *result.Machine;
+                auto wide = machine.NewObject();
+
+                for (int i = 0; i < 20; ++i)
+                    machine.Object(wide.key).add(
+                        "key" + ToString(i),
+                        machine.NewInteger(i)
+                    );
+
+                std::string path = (
+                    std::filesystem::temp_directory_path()
+                    / "JsonSnapshot_Test.bin"
+                ).string();
+
+                if (!machine.SaveSnapshot(path)) {
+                    expected = "Snapshot saved";
+                    actual = path;
+                    return false;
+                }
+
+                auto mapped = Json::MappedMachine::Open(path);
+
+                if (!mapped) {
+                    expected = "Snapshot opened";
+                    actual = path;
+                    return false;
+                }
+
+                expected = machine.GetResultSet(wide.key - 1).ToString();
+                actual = mapped->GetResultSet(wide.key - 1).ToString();
+
+                if (expected.compare(actual))
+                    return false;
+
+                expected = machine.GetResultSet().ToString();
+                actual = mapped->GetResultSet().ToString();
+
+                if (expected.compare(actual))
+                    return false;
+
+                auto cars = [](Json::MappedMachine::result_set_t expense) {
+                    return expense["WHAT"].Equals("Car");
+                };
+
+                int amount = 0;
+                auto persons = mapped->GetResultSet(wide.key - 1)["PERSONS"];
+                persons[0]["WEEK"][0]["NUMBER"].AsInteger(amount);
+
+                expected = "3 1 13 19";
+                actual = ToString(amount) + ' '
+                    + ToString((int)persons[0]["WEEK"][0]["EXPENSE"].Where(cars).size())
+                    + ' ' + mapped->GetResultSet()["key13"].ToString()
+                    + ' ' + mapped->GetResultSet()["key19"].ToString();
+
+                if (expected.compare(actual)) {
+                    std::filesystem::remove(path);
+                    return false;
+                }
+
+                // Compared and hashed as the Machine is
+                auto document = mapped->GetResultSet(wide.key - 1);
+
+                expected = "1 1 1";
+                actual = ToString(document.Equals(mapped->GetResultSet(wide.key - 1))) + ' '
+                    + ToString(document.Compare(mapped->GetResultSet()) != 0) + ' '
+                    + ToString(document.Hash() == machine.GetResultSet(wide.key - 1).Hash());
+
+                if (expected.compare(actual)) {
+                    std::filesystem::remove(path);
+                    return false;
+                }
+
+                std::string bytes;
+
+                {
+                    std::ifstream in(path, std::ios::binary);
+                    std::stringstream buffer;
+                    buffer << in.rdbuf();
+                    bytes = buffer.str();
+                }
+
+                std::filesystem::remove(path);
+
+                // Damaged copies are refused: a Start past the last
+                // object, then a list running past its section
+                auto damaged = [&](auto damage) {
+                    std::string copy = bytes;
+                    Json::SnapshotHeader header;
+                    std::memcpy(&header, copy.data(), sizeof header);
+                    damage(header, copy);
+                    std::memcpy(&copy[0], &header, sizeof header);
+
+                    {
+                        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+                        out.write(copy.data(), copy.size());
+                    }
+
+                    bool opened = (bool)Json::MappedMachine::Open(path);
+                    std::filesystem::remove(path);
+                    return opened ? "opened" : "refused";
+                };
+
+                expected = "refused refused";
+                actual = std::string(damaged([](Json::SnapshotHeader & header, std::string &) {
+                    header.Start = (int32_t)header.Objects;
+                }))
+                    + ' ' + damaged([](Json::SnapshotHeader & header, std::string & copy) {
+                        uint64_t end = 0;
+                        size_t at = header.Offsets[Json::SnapshotHeader::LISTS]
+                            + sizeof end * header.Lists;
+                        std::memcpy(&end, &copy[at], sizeof end);
+                        end = end + 1;
+                        std::memcpy(&copy[at], &end, sizeof end);
+                    });
+
+                if (expected.compare(actual))
+                    return false;
+
+                // Not a snapshot
+                expected = "null";
+                actual = Json::MappedMachine::Open(
+                    Tests::WorkingDirectory + "/res/input02.json"
+                ) ? "not null" : "null";
+
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonMachine_Compact_Should_DropUnreachableValues",
+            [](std::string & actual, std::string & expected) -> bool {
+                std::stringstream input(
+                    "{ \"keep\": [ 1, \"two\", 3.5, true ], "
+                    "\"drop\": { \"a\": [ \"x\", \"y\", \"z\" ], \"b\": 2 } }"
+                );
+
+                auto result = Json::RunMyParser(input);
+
+                if (!result.Success) {
+                    expected = "Success";
+                    actual = result.Message;
+                    return false;
+                }
+
+                auto & machine = *result.Machine;
+                auto document = machine.GetResultSet();
+
+                // Orphans the old subtree. The new list holds one
+                // string twice.
+                auto shared = machine.NewString("same");
+                auto list = machine.NewList();
+                machine.List(list.key).push_back(shared);
+                machine.List(list.key).push_back(shared);
+
+                for (Json::key_t i = 0; i < machine.ObjectCount(); ++i)
+                    if (machine.Object(i).hasKey("drop"))
+                        machine.Object(i)["drop"] = list;
+
+                expected = document.ToString();
+                auto before = machine.Stats();
+                size_t reclaimed = machine.Compact();
+                auto after = machine.Stats();
+                actual = machine.GetResultSet().ToString();
+
+                if (expected.compare(actual))
+                    return false;
+
+                expected = "2 1 1 1 2 1 true";
+                actual = ToString((int)after.Strings.Count) + ' '
+                    + ToString((int)after.Integers.Count) + ' '
+                    + ToString((int)after.Floats.Count) + ' '
+                    + ToString((int)after.Booleans.Count) + ' '
+                    + ToString((int)after.Lists.Count) + ' '
+                    + ToString((int)after.Objects.Count) + ' '
+                    + (reclaimed > 0 && reclaimed
+                        == before.Total.BytesReserved - after.Total.BytesReserved
+                        ? "true" : "false");
+
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonParseSession_Should_ReuseOneMachine",
+            [](std::string & actual, std::string & expected) -> bool {
+                std::vector<std::string> documents {
+                    "{ \"id\": 1, \"tags\": [ \"a\", \"b\" ], \"ok\": true }",
+                    "{ \"id\": 2, \"price\": 2.5, \"owner\": { \"name\": \"a somewhat longer name\" } }",
+                    "{ \"id\": 3, \"tags\": [ \"c\" ], \"ok\": false, \"none\": null }"
+                };
+
+                Json::ParseSession session;
+                size_t growths = 0;
+
+                for (int pass = 0; pass < 3; ++pass) {
+                    for (auto & document : documents) {
+                        std::stringstream input(document);
+                        expected = Json::RunMyParser(input).Machine->GetResultSet().ToString();
+
+                        auto result = session.Parse(document);
+
+                        if (!result.Success) {
+                            actual = result.Message;
+                            return false;
+                        }
+
+                        actual = result.Machine->GetResultSet().ToString();
+
+                        if (expected.compare(actual))
+                            return false;
+                    }
+
+                    auto result = session.Parse(documents[0]);
+                    size_t total = result.Machine->Stats().Total.Growths;
+
+                    // Every pool has room for the documents after the
+                    // first pass
+                    if (pass > 0 && total != growths) {
+                        expected = ToString((int)growths) + " growths";
+                        actual = ToString((int)total) + " growths";
+                        return false;
+                    }
+
+                    growths = total;
+                }
+
+                // A held Machine is left alone
+                auto held = session.Parse(documents[0]);
+                auto next = session.Parse("{ \"id\": [ }");
+                auto last = session.Parse(documents[2]);
+
+                expected = "true false true true";
+                actual = std::string(held.Machine != last.Machine ? "true" : "false") + ' '
+                    + (next.Success ? "true" : "false") + ' '
+                    + (!held.Machine->GetResultSet()["tags"][1].ToString().compare("b")
+                        ? "true" : "false") + ' '
+                    + (last.Machine->GetResultSet()["none"].IsNil() ? "true" : "false");
+
+                if (expected.compare(actual))
+                    return false;
+
+                // Capacity that Clear keeps for reuse is still reserved
+                Json::Machine machine;
+                auto list = machine.NewList();
+
+                for (int i = 0; i < 100; ++i)
+                    machine.List(list.key).push_back(machine.NewString(std::string(40, 'x')));
+
+                size_t reserved = machine.Stats().Total.BytesReserved;
+                machine.Clear();
+                auto cleared = machine.Stats();
+
+                expected = "0 0 true";
+                actual = ToString((int)cleared.Strings.Count) + ' '
+                    + ToString((int)cleared.Lists.Count) + ' '
+                    + (cleared.Total.BytesReserved >= reserved ? "true" : "false");
+
+                if (expected.compare(actual))
+                    return false;
+
+                // Documents whose keys keep changing fill the shape
+                // tree, which the session then starts over
+                Json::ParseSession varied;
+                const size_t MAX_SHAPES = Json::object_t::shape_t::MAX_SHAPES;
+                size_t largest = 0;
+                bool shared = false;
+
+                for (size_t i = 0; i < MAX_SHAPES + 64; ++i) {
+                    auto result = varied.Parse(
+                        "{ \"a" + ToString((int)(i / 64)) + "\": 1, "
+                        "\"b" + ToString((int)(i % 64)) + "\": 2 }"
+                    );
+
+                    auto & shape = result.Machine->Object(0).shape();
+                    largest = std::max(largest, shape->count());
+                    shared = !shape->dictionary();
+                }
+
+                expected = ToString((int)MAX_SHAPES) + " true";
+                actual = ToString((int)largest) + ' ' + (shared ? "true" : "false");
+
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonVersionedMachine_Should_KeepOldVersionsUnchanged",
+            [](std::string & actual, std::string & expected) -> bool {
+                std::stringstream input(
+                    "{ \"name\": \"first\", \"count\": 1, \"ratio\": 0.5, "
+                    "\"live\": true, \"items\": [ 10, 20 ] }"
+                );
+
+                Json::VersionedMachine machine(Json::GetMachine(input));
+                auto first = machine.Current();
+                std::string before = first->GetResultSet().ToString();
+
+                auto second = machine.Update([](Json::MachineVersion & draft) {
+                    auto root = draft.GetResultSet();
+                    root["name"].ChangeString("second");
+                    root["count"].ChangeInteger(2);
+                    root["items"][1].ChangeInteger(21);
+                    root["live"].ChangeInteger(false);
+                });
+
+                auto third = machine.Update([](Json::MachineVersion & draft) {
+                    draft.GetResultSet()["ratio"].ChangeFloat(0.25f);
+                });
+
+                expected = before;
+                actual = first->GetResultSet().ToString();
+
+                if (expected.compare(actual))
+                    return false;
+
+                expected = "1 2 3 second 21 false 0.5 0.25 first";
+                actual = ToString((int)second->Number()) + ' '
+                    + ToString((int)third->Number()) + ' '
+                    // Strings, integers and booleans
+                    + ToString((int)second->ChunksCopied()) + ' '
+                    + std::string(third->String(0)) + ' '
+                    + third->GetResultSet()["items"][1].ToString() + ' '
+                    + third->GetResultSet()["live"].ToString() + ' '
+                    + second->GetResultSet()["ratio"].ToString() + ' '
+                    + third->GetResultSet()["ratio"].ToString() + ' '
+                    + std::string(first->String(0));
+
+                return !expected.compare(actual)
+                    && machine.Current() == third;
+            }
+        },
+        {
+            "JsonFrozenMachine_Should_ServeConcurrentReaders",
+            [](std::string & actual, std::string & expected) -> bool {
+                const int READERS = 4;
+
+                std::stringstream input(
+                    "{ \"a\": [ 1, 2, 3 ], \"b\": { \"c\": 2.5, \"d\": \"e\" }, "
+                    "\"r\": [ { \"k\": 1 }, { \"k\": 2.5 }, { \"k\": 1 } ] }"
+                );
+
+                Json::ParseOptions options;
+                options.RawNumbers = true;
+                auto result = Json::RunMyParser(input, options);
+                expected = result.Machine->GetResultSet().ToString();
+
+                Json::FrozenMachine frozen(std::move(*result.Machine));
+                std::vector<std::string> results(READERS);
+                std::vector<std::thread> readers;
+
+                for (int i = 0; i < READERS; ++i)
+                    readers.emplace_back([&frozen, &results, i]() {
+                        int sum = 0;
+
+                        size_t found = 0;
+
+                        for (int n = 0; n < 1000; ++n) {
+                            int value = 0;
+                            frozen.GetResultSet()["a"][n % 3].AsInteger(value);
+                            sum += value;
+
+                            // The first lookups build the indexes
+                            auto records = frozen.GetResultSet()["r"];
+                            found += records.WhereEquals("k", 1).size()
+                                + records.WhereBetween("k", 2.0, 3.0).size();
+                        }
+
+                        results[i] = ToString(sum) + ' ' + ToString(found) + ' '
+                            + frozen.GetResultSet().ToString();
+                    });
+
+                for (auto & reader : readers)
+                    reader.join();
+
+                // 333 * (1 + 2 + 3) + 1, then 1000 * (2 + 1)
+                expected = "1999 3000 " + expected;
+
+                for (auto & reader : results) {
+                    actual = reader;
+
+                    if (expected.compare(actual))
+                        return false;
+                }
+
+                return true;
+            }
+        },
+        {
+            "JsonMachine_Merge_Should_RebaseTheOtherRoot",
+            [](std::string & actual, std::string & expected) -> bool {
+                // Booleans that do not end on a word, then more than a
+                // word of them
+                std::string flags = "[ ";
+
+                for (int i = 0; i < 70; ++i)
+                    flags += std::string(i ? ", " : "") + (i % 3 ? "true" : "false");
+
+                flags += " ]";
+
+                std::stringstream first(
+                    "{ \"name\": \"first\", \"flags\": [ true, false, true ], \"n\": 1 }"
+                );
+
+                std::stringstream second(
+                    "{ \"name\": \"second\", \"flags\": " + flags + ", "
+                    "\"nested\": { \"n\": 2, \"x\": 2.5 } }"
+                );
+
+                auto machine = Json::RunMyParser(first).Machine;
+                auto other = Json::RunMyParser(second).Machine;
+                Json::key_t root = machine->ObjectCount() - 1;
+
+                auto merged = machine->Merge(*other);
+                machine->Object(root)["other"] = merged;
+
+                expected = other->GetResultSet().ToString() + " [ true, false, true ]";
+                actual = machine->GetResultSet(root)["other"].ToString() + ' '
+                    + machine->GetResultSet(root)["flags"].ToString();
+
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonColumns_Should_SkipNullsInAggregates",
+            [](std::string & actual, std::string & expected) -> bool {
+                // Over a block of 64, so that full and partial blocks
+                // are both folded
+                std::string records = "{ \"records\": [ ";
+
+                for (int i = 0; i < 70; ++i)
+                    records += (i ? ", " : "") + std::string("{ \"n\": ")
+                        + ToString(i) + ", \"x\": "
+                        + (i % 10 == 3 ? "\"none\"" : ToString(100 - i) + ".5")
+                        + (i == 5 ? ", \"flag\": true" : "") + " }";
+
+                records += ", 7 ] }";
+                std::stringstream input(records);
+                auto result = Json::RunMyParser(input);
+
+                if (!result.Success) {
+                    expected = "Success";
+                    actual = result.Message;
+                    return false;
+                }
+
+                std::vector<std::string> fields = { "n", "x", "flag", "missing" };
+
+                auto describe = [&](auto records) {
+                    std::ostringstream out;
+
+                    for (auto & column : records.Columns(fields))
+                        out << column.Name() << ' ' << column.Size() << ' '
+                            << column.Count() << ' ' << column.Sum() << ' '
+                            << column.Min() << ' ' << column.Max() << ' '
+                            << column.Mean() << '\n';
+
+                    return out.str();
+                };
+
+                // x skips 3, 13, ..., 63 and the last record, which
+                // is not an object
+                expected =
+                    "n 71 70 2415 0 69 34.5\n"
+                    "x 71 63 4147.5 31.5 100.5 65.8333\n"
+                    "flag 71 1 1 1 1 1\n"
+                    "missing 71 0 0 0 0 0\n";
+
+                actual = describe(result.Machine->GetResultSet()["records"]);
+
+                if (expected.compare(actual))
+                    return false;
+
+                // Any read-only Machine gives the same columns
+                Json::MachineVersion version(result.Machine);
+                actual = describe(std::as_const(version).GetResultSet()["records"]);
+
+                if (expected.compare(actual))
+                    return false;
+
+                std::string path = (
+                    std::filesystem::temp_directory_path()
+                    / "JsonColumns_Test.bin"
+                ).string();
+
+                result.Machine->SaveSnapshot(path);
+                auto mapped = Json::MappedMachine::Open(path);
+                std::filesystem::remove(path);
+
+                if (!mapped) {
+                    expected = "Snapshot opened";
+                    actual = path;
+                    return false;
+                }
+
+                actual = describe(mapped->GetResultSet()["records"]);
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonPatch_Should_TurnOneMachineIntoTheOther",
+            [](std::string & actual, std::string & expected) -> bool {
+                std::string text =
+                    "{ \"name\": \"a\", \"tags\": [ \"x\", \"y\", \"z\" ], "
+                    "\"nested\": { \"n\": 1, \"gone\": true }, "
+                    "\"list\": [ 1, 2, 3, 4 ] }";
+
+                std::stringstream first(text);
+                std::stringstream copy(text);
+
+                std::stringstream second(
+                    "{ \"name\": \"b\", \"tags\": [ \"x\", \"w\", \"y\", \"z\" ], "
+                    "\"nested\": { \"n\": 1, \"added\": 2.5 }, "
+                    "\"list\": [ 1, 4 ] }"
+                );
+
+                auto before = Json::RunMyParser(first).Machine;
+                auto target = Json::RunMyParser(copy).Machine;
+                auto after = Json::RunMyParser(second).Machine;
+
+                auto patch = before->Diff(*after);
+                bool applied = target->Apply(patch);
+
+                // The insertion into tags leaves the equal ends alone
+                expected = std::string("[ ")
+                    + "{ \"op\": \"replace\", \"path\": \"/name\", \"value\": \"b\" }, "
+                    + "{ \"op\": \"add\", \"path\": \"/tags/1\", \"value\": \"w\" }, "
+                    + "{ \"op\": \"remove\", \"path\": \"/nested/gone\" }, "
+                    + "{ \"op\": \"add\", \"path\": \"/nested/added\", \"value\": 2.5 }, "
+                    + "{ \"op\": \"remove\", \"path\": \"/list/1\" }, "
+                    + "{ \"op\": \"remove\", \"path\": \"/list/1\" } ]\n"
+                    + after->GetResultSet().ToString() + "\n[ ]";
+
+                actual = patch.ToString() + '\n'
+                    + (applied ? target->GetResultSet().ToString() : "not applied")
+                    + '\n' + target->Diff(*after).ToString();
+
+                if (expected.compare(actual))
+                    return false;
+
+                // Confirming equal hashes finds the same changes
+                expected = patch.ToString();
+                actual = before->Diff(*after, true).ToString();
+
+                if (expected.compare(actual))
+                    return false;
+
+                // A patch that fails part way leaves the Machine as it was
+                Json::Patch failing = patch;
+                failing.Operations.push_back(Json::PatchOperation {
+                    Json::PatchOperation::REMOVE,
+                    "/nested/missing",
+                    Json::Pointer()
+                });
+
+                std::stringstream untouched(text);
+                auto unpatched = Json::RunMyParser(untouched).Machine;
+                auto objects = unpatched->ObjectCount();
+                auto strings = unpatched->StringCount();
+
+                bool partial = unpatched->Apply(failing);
+
+                expected = "false " + before->GetResultSet().ToString() + " true";
+                actual = std::string(partial ? "true " : "false ")
+                    + unpatched->GetResultSet().ToString()
+                    + (objects == unpatched->ObjectCount()
+                        && strings == unpatched->StringCount() ? " true" : " false");
+
+                if (expected.compare(actual))
+                    return false;
+
+                // Nulls are written out, strings and paths escaped
+                Json::Machine plain;
+                Json::Machine quoted;
+                auto list = quoted.NewList();
+                quoted.List(list.key).push_back(Json::Pointer { Json::Type::NIL, 0 });
+
+                auto & plainRoot = plain.Object(plain.NewObject().key);
+                plainRoot.add("a\"b", plain.NewInteger(1));
+                plainRoot.add("s", plain.NewString("x"));
+
+                auto & quotedRoot = quoted.Object(quoted.NewObject().key);
+                quotedRoot.add("a\"b", Json::Pointer { Json::Type::NIL, 0 });
+                quotedRoot.add("s", quoted.NewString("say \"hi\"\n"));
+                quotedRoot.add("n", list);
+
+                expected = std::string("[ ")
+                    + "{ \"op\": \"replace\", \"path\": \"/a\\\"b\", \"value\": null }, "
+                    + "{ \"op\": \"replace\", \"path\": \"/s\", \"value\": \"say \\\"hi\\\"\\n\" }, "
+                    + "{ \"op\": \"add\", \"path\": \"/n\", \"value\": [ null ] } ]";
+
+                actual = plain.Diff(quoted).ToString();
+
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonResultSet_Equals_Should_CompareByType",
+            [](std::string & actual, std::string & expected) -> bool {
+                std::stringstream input(
+                    "{ \"a\": 1, \"b\": 1.0, \"c\": \"1\", \"d\": true, "
+                    "\"e\": [ 1, 2 ], \"f\": [ 1, 2.0 ], "
+                    "\"g\": { \"x\": 1, \"y\": [ true ] }, "
+                    "\"h\": { \"y\": [ true ], \"x\": 1.0 } }"
+                );
+
+                auto result = Json::RunMyParser(input);
+                auto root = result.Machine->GetResultSet();
+                auto a = root["a"];
+                auto b = root["b"];
+                auto c = root["c"];
+                auto g = root["g"];
+                auto h = root["h"];
+
+                // Objects equal in any order of keys, integers and
+                // floats by value. A string equals only a string.
+                std::ostringstream out;
+
+                out << a.Equals(b) << a.Equals(c) << a.Equals(1)
+                    << b.Equals(1) << b.Equals(1.0) << b.Equals(true)
+                    << c.Equals("1") << a.Equals("1") << root["d"].Equals(true)
+                    << root["d"].Equals("true") << root["e"].Equals(root["f"])
+                    << g.Equals(h) << (g.Hash() == h.Hash()) << ' '
+                    << a.Compare(b) << a.Compare(c) << root["e"].Compare(g)
+                    << g.Compare(root["e"]) << ' ';
+
+                // A change drops the cached hashes
+                g["x"].ChangeInteger(2);
+                out << g.Equals(h) << (g.Hash() == h.Hash()) << g.Compare(h);
+
+                expected = "1011101010111 0-1-11 001";
+                actual = out.str();
+                return !expected.compare(actual);
+            }
+        },
+        {
+            "JsonIndex_Should_FindRecordsUntilChanged",
+            [](std::string & actual, std::string & expected) -> bool {
+                std::stringstream input(
+                    "{ \"records\": [ "
+                    "{ \"who\": \"Joe\", \"n\": 3 }, "
+                    "{ \"who\": \"Janet\", \"n\": 2.0 }, "
+                    "{ \"who\": \"Beth\", \"n\": \"2\" }, "
+                    "{ \"who\": \"Janet\", \"n\": 2 }, "
+                    "7, "
+                    "{ \"who\": \"Jim\", \"n\": 1.5 } ] }"
+                );
+
+                auto result = Json::RunMyParser(input);
+                auto records = result.Machine->GetResultSet()["records"];
+
+                auto names = [](const auto & found) {
+                    std::string text;
+
+                    for (auto & record : found)
+                        text += record["who"].ToString() + ' ';
+
+                    return text;
+                };
+
+                // Typed: the string "2" is not the number 2
+                std::string text = names(records.WhereEquals("who", "Janet"))
+                    + "| " + names(records.WhereEquals("n", 2))
+                    + "| " + names(records.WhereBetween("n", 1.5, 2.5))
+                    + "| ";
+
+                records[0]["who"].ChangeString("Janet");
+                records[3]["n"].ChangeInteger(5);
+
+                text += names(records.WhereEquals("who", "Janet"))
+                    + "| " + names(records.WhereBetween("n", 1.5, 2.5));
+
+                expected = "Janet Janet | Janet Janet | Jim Janet Janet | "
+                    "Janet Janet Janet | Jim Janet ";
+
+                actual = text;
+
+                if (expected.compare(actual))
+                    return false;
+
+                // An integer that no float holds, looked up as a
+                // double. Any read-only Machine finds the same.
+                std::stringstream large(
+                    "{ \"records\": [ "
+                    "{ \"who\": \"Ann\", \"n\": 16777217 }, "
+                    "{ \"who\": \"Bob\", \"n\": 16777216 }, "
+                    "{ \"who\": \"Cal\", \"n\": 0.5 } ] }"
+                );
+
+                auto machine = Json::RunMyParser(large).Machine;
+
+                auto lookUp = [&](auto found) {
+                    return names(found.WhereEquals("n", 16777217.0))
+                        + "| " + names(found.WhereEquals("n", 0.5))
+                        + "| " + names(found.WhereEquals("who", "Bob"))
+                        + "| " + names(found.WhereBetween("n", 1.0, 16777216.0));
+                };
+
+                expected = "Ann | Cal | Bob | Bob ";
+                actual = lookUp(machine->GetResultSet()["records"]);
+
+                if (expected.compare(actual))
+                    return false;
+
+                Json::MachineVersion version(machine);
+                actual = lookUp(std::as_const(version).GetResultSet()["records"]);
+
+                if (expected.compare(actual))
+                    return false;
+
+                std::string path = (
+                    std::filesystem::temp_directory_path()
+                    / "JsonIndex_Test.bin"
+                ).string();
+
+                machine->SaveSnapshot(path);
+                auto mapped = Json::MappedMachine::Open(path);
+                std::filesystem::remove(path);
+
+                if (!mapped) {
+                    expected = "Snapshot opened";
+                    actual = path;
+                    return false;
+                }
+
+                actual = lookUp(mapped->GetResultSet()["records"]);
+                return !expected.compare(actual);
+            }
         }
     };
-}
+}
\ No newline at end of file